@@ -0,0 +1,361 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "AtlasPacker.h"
+#include "ImageDecoder.h"
+
+namespace mg
+{
+	static int alignUp(int value, int alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	SkylinePacker::SkylinePacker(int binWidth, int binHeight)
+		: width(0), height(0), usedArea(0)
+	{
+		reset(binWidth, binHeight);
+	}
+
+	void SkylinePacker::reset(int binWidth, int binHeight)
+	{
+		width = binWidth;
+		height = binHeight;
+		usedArea = 0;
+
+		skyline.clear();
+		skyline.push_back({ 0, 0, binWidth });
+	}
+
+	bool SkylinePacker::insert(int rectWidth, int rectHeight, int& x, int& y)
+	{
+		int bestTop = INT_MAX;
+		int bestWaste = INT_MAX;
+		size_t bestIndex = 0;
+
+		for (size_t i = 0; i < skyline.size(); i++)
+		{
+			int waste;
+			int top = fit(i, rectWidth, rectHeight, waste);
+
+			if (top >= 0 && (top < bestTop || (top == bestTop && waste < bestWaste)))
+			{
+				bestTop = top;
+				bestWaste = waste;
+				bestIndex = i;
+			}
+		}
+
+		if (bestTop == INT_MAX)
+			return false;
+
+		x = skyline[bestIndex].x;
+		y = bestTop - rectHeight;
+
+		addSegment(bestIndex, x, y, rectWidth, rectHeight);
+		usedArea += (long long)rectWidth * rectHeight;
+
+		return true;
+	}
+
+	int SkylinePacker::fit(size_t index, int rectWidth, int rectHeight, int& wastedArea) const
+	{
+		int x = skyline[index].x;
+
+		if (x + rectWidth > width)
+			return -1;
+
+		// Rectangle rests on the highest segment it spans
+		int y = 0;
+		int remaining = rectWidth;
+
+		for (size_t i = index; remaining > 0; i++)
+		{
+			y = skyline[i].y > y ? skyline[i].y : y;
+			remaining -= skyline[i].width;
+		}
+
+		if (y + rectHeight > height)
+			return -1;
+
+		// Gaps left below the rectangle can not be filled anymore
+		wastedArea = 0;
+		remaining = rectWidth;
+
+		for (size_t i = index; remaining > 0; i++)
+		{
+			int spanned = skyline[i].width < remaining ? skyline[i].width : remaining;
+			wastedArea += (y - skyline[i].y) * spanned;
+			remaining -= spanned;
+		}
+
+		return y + rectHeight;
+	}
+
+	void SkylinePacker::addSegment(size_t index, int x, int y, int rectWidth, int rectHeight)
+	{
+		skyline.insert(skyline.begin() + index, { x, y + rectHeight, rectWidth });
+
+		// Shrink or remove the segments now below the rectangle
+		int right = x + rectWidth;
+
+		for (size_t i = index + 1; i < skyline.size(); )
+		{
+			Segment& segment = skyline[i];
+
+			if (segment.x >= right)
+				break;
+
+			int overlap = right - segment.x;
+
+			if (overlap < segment.width)
+			{
+				segment.x += overlap;
+				segment.width -= overlap;
+				break;
+			}
+
+			skyline.erase(skyline.begin() + i);
+		}
+
+		// Join neighbours at the same height
+		for (size_t i = 0; i + 1 < skyline.size(); )
+		{
+			if (skyline[i].y == skyline[i + 1].y)
+			{
+				skyline[i].width += skyline[i + 1].width;
+				skyline.erase(skyline.begin() + i + 1);
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	void AtlasBuilder::add(const std::string& name, const unsigned char* pixels, int width, int height)
+	{
+		sources.push_back({ name, width, height, std::vector<unsigned char>(pixels, pixels + (size_t)width * height * 4) });
+	}
+
+	bool AtlasBuilder::addFile(const std::string& name, const std::string& path)
+	{
+		DecodedImage image;
+
+		if (!decodeImage(path, image, 4, true))
+		{
+			std::cout << "Failed to load " << path << " into the atlas!" << std::endl;
+			return false;
+		}
+
+		add(name, image.pixels.get(), image.width, image.height);
+
+		return true;
+	}
+
+	bool AtlasBuilder::build(const AtlasSettings& settings, AtlasLayout& layout) const
+	{
+		int padding = settings.padding;
+		int alignment = settings.alignment > 0 ? settings.alignment : 1;
+
+		// Gutter before each image, aligned so the image itself starts on a
+		// multiple of the alignment, at least padding after it
+		int lead = alignUp(padding, alignment);
+
+		// Cells of the packer hold an image with its gutters
+		std::vector<int> cellWidths(sources.size());
+		std::vector<int> cellHeights(sources.size());
+
+		long long area = 0;
+		int largestSide = 1;
+
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			cellWidths[i] = alignUp(lead + sources[i].width + padding, alignment);
+			cellHeights[i] = alignUp(lead + sources[i].height + padding, alignment);
+
+			area += (long long)cellWidths[i] * cellHeights[i];
+			largestSide = std::max(largestSide, std::max(cellWidths[i], cellHeights[i]));
+		}
+
+		// Tall images first leave the flattest skyline
+		std::vector<size_t> order(sources.size());
+
+		for (size_t i = 0; i < order.size(); i++)
+			order[i] = i;
+
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+		{
+			if (cellHeights[a] != cellHeights[b])
+				return cellHeights[a] > cellHeights[b];
+
+			return cellWidths[a] > cellWidths[b];
+		});
+
+		// Smallest power of two square covering the area, then grow one side at a time
+		int width = 1;
+		int height = 1;
+
+		while ((long long)width * height < area || width < largestSide || height < largestSide)
+		{
+			if (width <= height)
+				width *= 2;
+			else
+				height *= 2;
+		}
+
+		std::vector<int> cellX(sources.size());
+		std::vector<int> cellY(sources.size());
+
+		SkylinePacker packer(width, height);
+
+		while (true)
+		{
+			if (width > settings.maxSize || height > settings.maxSize)
+			{
+				std::cout << "Images do not fit in a " << settings.maxSize << "x" << settings.maxSize << " atlas!" << std::endl;
+				return false;
+			}
+
+			packer.reset(width, height);
+
+			bool packed = true;
+
+			for (size_t i : order)
+			{
+				if (!packer.insert(cellWidths[i], cellHeights[i], cellX[i], cellY[i]))
+				{
+					packed = false;
+					break;
+				}
+			}
+
+			if (packed)
+				break;
+
+			if (width <= height)
+				width *= 2;
+			else
+				height *= 2;
+		}
+
+		layout.width = width;
+		layout.height = height;
+		layout.pixels.assign((size_t)width * height * 4, 0);
+		layout.names.clear();
+		layout.regions.clear();
+
+		for (size_t i = 0; i < sources.size(); i++)
+		{
+			const Source& source = sources[i];
+
+			int x = cellX[i] + lead;
+			int y = cellY[i] + lead;
+
+			// Gutters after the image take the rest of the cell
+			int right = cellWidths[i] - lead - source.width;
+			int top = cellHeights[i] - lead - source.height;
+
+			// Copy the image and extrude its edges over the whole cell, corners included
+			for (int row = -lead; row < source.height + top; row++)
+			{
+				int sourceRow = std::min(std::max(row, 0), source.height - 1);
+
+				const unsigned char* sourcePixels = source.pixels.data() + (size_t)sourceRow * source.width * 4;
+				unsigned char* destination = layout.pixels.data() + ((size_t)(y + row) * width + x) * 4;
+
+				memcpy(destination, sourcePixels, (size_t)source.width * 4);
+
+				for (int column = 1; column <= lead; column++)
+					memcpy(destination - column * 4, sourcePixels, 4);
+
+				for (int column = 1; column <= right; column++)
+					memcpy(destination + (source.width - 1 + column) * 4, sourcePixels + (source.width - 1) * 4, 4);
+			}
+
+			AtlasRegion region;
+			region.x = x;
+			region.y = y;
+			region.width = source.width;
+			region.height = source.height;
+			region.uvRect = glm::vec4((float)x / width, (float)y / height,
+				(float)(x + source.width) / width, (float)(y + source.height) / height);
+
+			layout.names.push_back(source.name);
+			layout.regions.push_back(region);
+		}
+
+		std::cout << "Atlas " << width << "x" << height << " with " << sources.size() << " images, "
+			<< (int)(packer.getOccupancy() * 100.0f) << "% used" << std::endl;
+
+		return true;
+	}
+
+	bool saveAtlasTable(const std::string& path, const AtlasLayout& layout)
+	{
+		std::ofstream stream(path);
+
+		// Texels from the bottom left corner, names last so they may hold spaces
+		stream << "atlas " << layout.width << " " << layout.height << "\n";
+
+		for (size_t i = 0; i < layout.regions.size(); i++)
+		{
+			const AtlasRegion& region = layout.regions[i];
+			stream << region.x << " " << region.y << " " << region.width << " " << region.height << " " << layout.names[i] << "\n";
+		}
+
+		if (!stream)
+		{
+			std::cout << "Failed to write " << path << "!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool loadAtlasTable(const std::string& path, AtlasLayout& layout)
+	{
+		std::ifstream stream(path);
+
+		std::string line;
+		std::string keyword;
+
+		if (!std::getline(stream, line) || !(std::istringstream(line) >> keyword >> layout.width >> layout.height) || keyword != "atlas")
+		{
+			std::cout << "Failed to read atlas table " << path << "!" << std::endl;
+			return false;
+		}
+
+		layout.names.clear();
+		layout.regions.clear();
+
+		while (std::getline(stream, line))
+		{
+			std::istringstream lineStream(line);
+			AtlasRegion region;
+
+			if (!(lineStream >> region.x >> region.y >> region.width >> region.height))
+				continue;
+
+			std::string name;
+			std::getline(lineStream >> std::ws, name);
+
+			region.uvRect = glm::vec4((float)region.x / layout.width, (float)region.y / layout.height,
+				(float)(region.x + region.width) / layout.width, (float)(region.y + region.height) / layout.height);
+
+			layout.names.push_back(name);
+			layout.regions.push_back(region);
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,104 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "BindlessTextureTable.h"
+#include "GLExtensions.h"
+#include "Texture.h"
+
+namespace mg
+{
+	BindlessTextureTable::BindlessTextureTable(unsigned int bindingPoint, unsigned int capacity)
+		: handles((capacity + 1) & ~1u, 0), buffer("BindlessTextures", ((capacity + 1) & ~1u) * sizeof(uint64_t), bindingPoint),
+		  dirtyBegin(0), dirtyEnd(0)
+	{
+		// Lowest indices are handed out first
+		for (unsigned int i = (unsigned int)handles.size(); i > 0; i--)
+			freeIndices.push_back(i - 1);
+	}
+
+	BindlessTextureTable::~BindlessTextureTable()
+	{
+		for (auto& entry : indices)
+			GLExtensions::makeTextureHandleNonResident(handles[entry.second]);
+	}
+
+	unsigned int BindlessTextureTable::add(const Texture& texture)
+	{
+		auto it = indices.find(texture.getId());
+
+		if (it != indices.end())
+			return it->second;
+
+		if (freeIndices.empty())
+		{
+			std::cout << "Bindless texture table is full, " << handles.size() << " textures!" << std::endl;
+			return INVALID_INDEX;
+		}
+
+		unsigned int index = freeIndices.back();
+		freeIndices.pop_back();
+
+		// Same texture id gives the same handle, the driver keeps it until the texture is deleted
+		uint64_t handle = GLExtensions::getTextureHandle(texture.getId());
+		GLExtensions::makeTextureHandleResident(handle);
+
+		handles[index] = handle;
+		indices.emplace(texture.getId(), index);
+
+		markDirty(index);
+
+		return index;
+	}
+
+	void BindlessTextureTable::remove(const Texture& texture)
+	{
+		auto it = indices.find(texture.getId());
+
+		if (it == indices.end())
+			return;
+
+		unsigned int index = it->second;
+
+		GLExtensions::makeTextureHandleNonResident(handles[index]);
+
+		// Cleared so the slot holds no handle of a deleted texture, sampling
+		// it is still undefined, draws must not use the index any more
+		handles[index] = 0;
+
+		freeIndices.push_back(index);
+		indices.erase(it);
+
+		markDirty(index);
+	}
+
+	void BindlessTextureTable::markDirty(unsigned int index)
+	{
+		if (dirtyBegin >= dirtyEnd)
+		{
+			dirtyBegin = index;
+			dirtyEnd = index + 1;
+
+			return;
+		}
+
+		dirtyBegin = index < dirtyBegin ? index : dirtyBegin;
+		dirtyEnd = index + 1 > dirtyEnd ? index + 1 : dirtyEnd;
+	}
+
+	void BindlessTextureTable::update()
+	{
+		if (dirtyBegin >= dirtyEnd)
+			return;
+
+		buffer.setData(handles.data() + dirtyBegin, (dirtyEnd - dirtyBegin) * sizeof(uint64_t), dirtyBegin * sizeof(uint64_t));
+
+		dirtyBegin = 0;
+		dirtyEnd = 0;
+	}
+}
@@ -0,0 +1,755 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "BlockCompression.h"
+
+namespace mg
+{
+	// Fit a line through the selected texels, N is 3 for RGB or 4 for RGBA
+	// Returns false when no texel is selected
+	template<int N>
+	static bool principalAxis(const unsigned char* texels, const bool* skip, float* mean, float* axis)
+	{
+		int count = 0;
+
+		for (int c = 0; c < N; c++)
+			mean[c] = 0.0f;
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (skip && skip[i])
+				continue;
+
+			for (int c = 0; c < N; c++)
+				mean[c] += texels[i * 4 + c];
+
+			count++;
+		}
+
+		if (count == 0)
+			return false;
+
+		for (int c = 0; c < N; c++)
+			mean[c] /= count;
+
+		float covariance[N][N] = {};
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (skip && skip[i])
+				continue;
+
+			for (int a = 0; a < N; a++)
+			{
+				for (int b = 0; b < N; b++)
+					covariance[a][b] += (texels[i * 4 + a] - mean[a]) * (texels[i * 4 + b] - mean[b]);
+			}
+		}
+
+		// Power iteration converges to the direction of largest variance
+		for (int c = 0; c < N; c++)
+			axis[c] = 1.0f;
+
+		for (int iteration = 0; iteration < 8; iteration++)
+		{
+			float next[N] = {};
+			float largest = 0.0f;
+
+			for (int a = 0; a < N; a++)
+			{
+				for (int b = 0; b < N; b++)
+					next[a] += covariance[a][b] * axis[b];
+
+				largest = std::fmax(largest, std::fabs(next[a]));
+			}
+
+			// Every texel is the same color
+			if (largest < 1e-6f)
+				break;
+
+			for (int c = 0; c < N; c++)
+				axis[c] = next[c] / largest;
+		}
+
+		float length = 0.0f;
+
+		for (int c = 0; c < N; c++)
+			length += axis[c] * axis[c];
+
+		length = std::sqrt(length);
+
+		for (int c = 0; c < N; c++)
+			axis[c] /= length;
+
+		return true;
+	}
+
+	// Endpoints at both ends of the projection of the texels on the axis
+	template<int N>
+	static void fitEndpoints(const unsigned char* texels, const bool* skip, const float* mean, const float* axis, float* high, float* low)
+	{
+		float minimum = 0.0f;
+		float maximum = 0.0f;
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (skip && skip[i])
+				continue;
+
+			float t = 0.0f;
+
+			for (int c = 0; c < N; c++)
+				t += (texels[i * 4 + c] - mean[c]) * axis[c];
+
+			minimum = std::fmin(minimum, t);
+			maximum = std::fmax(maximum, t);
+		}
+
+		for (int c = 0; c < N; c++)
+		{
+			high[c] = std::fmin(std::fmax(mean[c] + axis[c] * maximum, 0.0f), 255.0f);
+			low[c]  = std::fmin(std::fmax(mean[c] + axis[c] * minimum, 0.0f), 255.0f);
+		}
+	}
+
+	// BC1 / BC3 color
+
+	static uint16_t toRGB565(const float* color)
+	{
+		unsigned int r = (unsigned int)(color[0] * 31.0f / 255.0f + 0.5f);
+		unsigned int g = (unsigned int)(color[1] * 63.0f / 255.0f + 0.5f);
+		unsigned int b = (unsigned int)(color[2] * 31.0f / 255.0f + 0.5f);
+
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	static void fromRGB565(uint16_t color, int* rgb)
+	{
+		int r = (color >> 11) & 31;
+		int g = (color >> 5) & 63;
+		int b = color & 31;
+
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	static void buildColorPalette(uint16_t color0, uint16_t color1, bool threeColor, int palette[4][3])
+	{
+		fromRGB565(color0, palette[0]);
+		fromRGB565(color1, palette[1]);
+
+		for (int c = 0; c < 3; c++)
+		{
+			if (threeColor)
+			{
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			else
+			{
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+		}
+	}
+
+	// Nearest palette entry of every texel, returns the squared error
+	static int selectColorIndices(const unsigned char* texels, const bool* transparent, uint16_t color0, uint16_t color1,
+		bool threeColor, unsigned int* indices)
+	{
+		int palette[4][3];
+		buildColorPalette(color0, color1, threeColor, palette);
+
+		int entries = threeColor ? 3 : 4;
+		int totalError = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			if (transparent[i])
+			{
+				indices[i] = 3;
+				continue;
+			}
+
+			int bestError = INT32_MAX;
+
+			for (int entry = 0; entry < entries; entry++)
+			{
+				int error = 0;
+
+				for (int c = 0; c < 3; c++)
+				{
+					int difference = texels[i * 4 + c] - palette[entry][c];
+					error += difference * difference;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = entry;
+				}
+			}
+
+			totalError += bestError;
+		}
+
+		return totalError;
+	}
+
+	// Least squares endpoints for the chosen indices of a 4 color block
+	static bool refineEndpoints(const unsigned char* texels, const unsigned int* indices, float* high, float* low)
+	{
+		static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[3] = {}, bx[3] = {};
+
+		for (int i = 0; i < 16; i++)
+		{
+			float alpha = weights[indices[i]];
+			float beta = 1.0f - alpha;
+
+			aa += alpha * alpha;
+			bb += beta * beta;
+			ab += alpha * beta;
+
+			for (int c = 0; c < 3; c++)
+			{
+				ax[c] += alpha * texels[i * 4 + c];
+				bx[c] += beta * texels[i * 4 + c];
+			}
+		}
+
+		float determinant = aa * bb - ab * ab;
+
+		if (std::fabs(determinant) < 1e-6f)
+			return false;
+
+		for (int c = 0; c < 3; c++)
+		{
+			high[c] = std::fmin(std::fmax((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+			low[c]  = std::fmin(std::fmax((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+		}
+
+		return true;
+	}
+
+	static void encodeColorBlock(const unsigned char* texels, unsigned char* block, bool allowTransparent)
+	{
+		bool transparent[16];
+		bool anyTransparent = false;
+
+		for (int i = 0; i < 16; i++)
+		{
+			transparent[i] = allowTransparent && texels[i * 4 + 3] < 128;
+			anyTransparent = anyTransparent || transparent[i];
+		}
+
+		float mean[3], axis[3], high[3], low[3];
+
+		// Every texel transparent, equal endpoints and index 3 everywhere
+		if (!principalAxis<3>(texels, transparent, mean, axis))
+		{
+			memset(block, 0, 4);
+			memset(block + 4, 0xFF, 4);
+			return;
+		}
+
+		fitEndpoints<3>(texels, transparent, mean, axis, high, low);
+
+		// Punch through alpha needs the 3 color mode, its index 3 is transparent
+		bool threeColor = anyTransparent;
+
+		uint16_t color0 = toRGB565(high);
+		uint16_t color1 = toRGB565(low);
+
+		unsigned int indices[16];
+		int error = selectColorIndices(texels, transparent, color0, color1, threeColor, indices);
+
+		if (!threeColor && refineEndpoints(texels, indices, high, low))
+		{
+			uint16_t refined0 = toRGB565(high);
+			uint16_t refined1 = toRGB565(low);
+
+			unsigned int refinedIndices[16];
+			int refinedError = selectColorIndices(texels, transparent, refined0, refined1, false, refinedIndices);
+
+			if (refinedError < error)
+			{
+				color0 = refined0;
+				color1 = refined1;
+				memcpy(indices, refinedIndices, sizeof(indices));
+			}
+		}
+
+		// Endpoint order tells the decoder which mode the block uses
+		if (!threeColor && color0 < color1)
+		{
+			uint16_t swap = color0; color0 = color1; color1 = swap;
+
+			for (int i = 0; i < 16; i++)
+				indices[i] ^= 1;
+		}
+		else if (threeColor && color0 > color1)
+		{
+			uint16_t swap = color0; color0 = color1; color1 = swap;
+
+			for (int i = 0; i < 16; i++)
+			{
+				if (indices[i] < 2)
+					indices[i] ^= 1;
+			}
+		}
+
+		// Equal endpoints read as 3 color mode, where index 3 would be black
+		if (!threeColor && color0 == color1)
+		{
+			for (int i = 0; i < 16; i++)
+				indices[i] = 0;
+		}
+
+		uint32_t packedIndices = 0;
+
+		for (int i = 0; i < 16; i++)
+			packedIndices |= indices[i] << (2 * i);
+
+		block[0] = (unsigned char)(color0 & 0xFF);
+		block[1] = (unsigned char)(color0 >> 8);
+		block[2] = (unsigned char)(color1 & 0xFF);
+		block[3] = (unsigned char)(color1 >> 8);
+
+		for (int i = 0; i < 4; i++)
+			block[4 + i] = (unsigned char)(packedIndices >> (8 * i));
+	}
+
+	static void decodeColorBlock(const unsigned char* block, unsigned char* texels, bool allowThreeColor)
+	{
+		uint16_t color0 = (uint16_t)(block[0] | (block[1] << 8));
+		uint16_t color1 = (uint16_t)(block[2] | (block[3] << 8));
+
+		bool threeColor = allowThreeColor && color0 <= color1;
+
+		int palette[4][3];
+		buildColorPalette(color0, color1, threeColor, palette);
+
+		uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+
+		for (int i = 0; i < 16; i++)
+		{
+			unsigned int index = (indices >> (2 * i)) & 3;
+
+			for (int c = 0; c < 3; c++)
+				texels[i * 4 + c] = (unsigned char)palette[index][c];
+
+			texels[i * 4 + 3] = threeColor && index == 3 ? 0 : 255;
+		}
+	}
+
+	// BC3 alpha
+
+	static void buildAlphaPalette(int alpha0, int alpha1, int palette[8])
+	{
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+
+		if (alpha0 > alpha1)
+		{
+			for (int k = 1; k < 7; k++)
+				palette[k + 1] = ((7 - k) * alpha0 + k * alpha1) / 7;
+		}
+		else
+		{
+			for (int k = 1; k < 5; k++)
+				palette[k + 1] = ((5 - k) * alpha0 + k * alpha1) / 5;
+
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	static void encodeAlphaBlock(const unsigned char* texels, unsigned char* block)
+	{
+		int minimum = 255;
+		int maximum = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			int alpha = texels[i * 4 + 3];
+			minimum = alpha < minimum ? alpha : minimum;
+			maximum = alpha > maximum ? alpha : maximum;
+		}
+
+		// 8 value mode, equal endpoints fall back to 6 value mode with index 0 exact
+		int palette[8];
+		buildAlphaPalette(maximum, minimum, palette);
+
+		uint64_t indices = 0;
+
+		for (int i = 0; i < 16; i++)
+		{
+			int alpha = texels[i * 4 + 3];
+			int bestError = INT32_MAX;
+			uint64_t bestIndex = 0;
+
+			for (int entry = 0; entry < 8; entry++)
+			{
+				int error = std::abs(alpha - palette[entry]);
+
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = entry;
+				}
+			}
+
+			indices |= bestIndex << (3 * i);
+		}
+
+		block[0] = (unsigned char)maximum;
+		block[1] = (unsigned char)minimum;
+
+		for (int i = 0; i < 6; i++)
+			block[2 + i] = (unsigned char)(indices >> (8 * i));
+	}
+
+	static void decodeAlphaBlock(const unsigned char* block, unsigned char* texels)
+	{
+		int palette[8];
+		buildAlphaPalette(block[0], block[1], palette);
+
+		uint64_t indices = 0;
+
+		for (int i = 0; i < 6; i++)
+			indices |= (uint64_t)block[2 + i] << (8 * i);
+
+		for (int i = 0; i < 16; i++)
+			texels[i * 4 + 3] = (unsigned char)palette[(indices >> (3 * i)) & 7];
+	}
+
+	// BC7 mode 6
+
+	static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Fields of a BC7 block, least significant bit first
+	struct BitStream
+	{
+		unsigned char* data;
+		unsigned int position;
+
+		void write(unsigned int value, unsigned int count)
+		{
+			for (unsigned int i = 0; i < count; i++, position++)
+			{
+				if ((value >> i) & 1)
+					data[position >> 3] |= (unsigned char)(1 << (position & 7));
+			}
+		}
+
+		unsigned int read(unsigned int count)
+		{
+			unsigned int value = 0;
+
+			for (unsigned int i = 0; i < count; i++, position++)
+				value |= ((data[position >> 3] >> (position & 7)) & 1u) << i;
+
+			return value;
+		}
+	};
+
+	// 7 bits per channel and a parity bit shared by the 4 channels, the
+	// parity bit with the lowest error is kept
+	static void quantizeBC7Endpoint(const float* endpoint, unsigned int* quantized, unsigned int& parity)
+	{
+		float bestError = 1e30f;
+
+		for (unsigned int p = 0; p < 2; p++)
+		{
+			unsigned int values[4];
+			float error = 0.0f;
+
+			for (int c = 0; c < 4; c++)
+			{
+				int value = (int)std::lround((endpoint[c] - p) / 2.0f);
+				value = value < 0 ? 0 : (value > 127 ? 127 : value);
+
+				values[c] = value;
+
+				float difference = (float)((value << 1) | p) - endpoint[c];
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				parity = p;
+				memcpy(quantized, values, sizeof(values));
+			}
+		}
+	}
+
+	void encodeBC7Block(const unsigned char* texels, unsigned char* block)
+	{
+		float mean[4], axis[4], high[4], low[4];
+		principalAxis<4>(texels, nullptr, mean, axis);
+		fitEndpoints<4>(texels, nullptr, mean, axis, high, low);
+
+		unsigned int endpoints[2][4];
+		unsigned int parity[2];
+		quantizeBC7Endpoint(high, endpoints[0], parity[0]);
+		quantizeBC7Endpoint(low, endpoints[1], parity[1]);
+
+		int palette[16][4];
+
+		for (int entry = 0; entry < 16; entry++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				int a = (endpoints[0][c] << 1) | parity[0];
+				int b = (endpoints[1][c] << 1) | parity[1];
+
+				palette[entry][c] = ((64 - BC7_WEIGHTS[entry]) * a + BC7_WEIGHTS[entry] * b + 32) >> 6;
+			}
+		}
+
+		unsigned int indices[16];
+
+		for (int i = 0; i < 16; i++)
+		{
+			int bestError = INT32_MAX;
+
+			for (int entry = 0; entry < 16; entry++)
+			{
+				int error = 0;
+
+				for (int c = 0; c < 4; c++)
+				{
+					int difference = texels[i * 4 + c] - palette[entry][c];
+					error += difference * difference;
+				}
+
+				if (error < bestError)
+				{
+					bestError = error;
+					indices[i] = entry;
+				}
+			}
+		}
+
+		// Top bit of the first index is implicit zero, swap endpoints when it is set
+		if (indices[0] & 8)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				unsigned int swap = endpoints[0][c];
+				endpoints[0][c] = endpoints[1][c];
+				endpoints[1][c] = swap;
+			}
+
+			unsigned int swap = parity[0];
+			parity[0] = parity[1];
+			parity[1] = swap;
+
+			for (int i = 0; i < 16; i++)
+				indices[i] = 15 - indices[i];
+		}
+
+		memset(block, 0, 16);
+		BitStream stream = { block, 0 };
+
+		// Mode 6 is six zero bits and a one
+		stream.write(1 << 6, 7);
+
+		for (int c = 0; c < 4; c++)
+		{
+			stream.write(endpoints[0][c], 7);
+			stream.write(endpoints[1][c], 7);
+		}
+
+		stream.write(parity[0], 1);
+		stream.write(parity[1], 1);
+
+		stream.write(indices[0], 3);
+
+		for (int i = 1; i < 16; i++)
+			stream.write(indices[i], 4);
+	}
+
+	void decodeBC7Block(const unsigned char* block, unsigned char* texels)
+	{
+		if ((block[0] & 0x7F) != 0x40)
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				texels[i * 4 + 0] = 255;
+				texels[i * 4 + 1] = 0;
+				texels[i * 4 + 2] = 255;
+				texels[i * 4 + 3] = 255;
+			}
+
+			return;
+		}
+
+		BitStream stream = { (unsigned char*)block, 7 };
+
+		unsigned int endpoints[2][4];
+
+		for (int c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = stream.read(7);
+			endpoints[1][c] = stream.read(7);
+		}
+
+		unsigned int parity0 = stream.read(1);
+		unsigned int parity1 = stream.read(1);
+
+		for (int i = 0; i < 16; i++)
+		{
+			unsigned int index = stream.read(i == 0 ? 3 : 4);
+
+			for (int c = 0; c < 4; c++)
+			{
+				int a = (endpoints[0][c] << 1) | parity0;
+				int b = (endpoints[1][c] << 1) | parity1;
+
+				texels[i * 4 + c] = (unsigned char)(((64 - BC7_WEIGHTS[index]) * a + BC7_WEIGHTS[index] * b + 32) >> 6);
+			}
+		}
+	}
+
+	void encodeBC1Block(const unsigned char* texels, unsigned char* block)
+	{
+		encodeColorBlock(texels, block, true);
+	}
+
+	void encodeBC3Block(const unsigned char* texels, unsigned char* block)
+	{
+		encodeAlphaBlock(texels, block);
+		encodeColorBlock(texels, block + 8, false);
+	}
+
+	void decodeBC1Block(const unsigned char* block, unsigned char* texels)
+	{
+		decodeColorBlock(block, texels, true);
+	}
+
+	void decodeBC3Block(const unsigned char* block, unsigned char* texels)
+	{
+		decodeColorBlock(block + 8, texels, false);
+		decodeAlphaBlock(block, texels);
+	}
+
+	size_t getBlockSize(CompressedFormat format)
+	{
+		switch (format)
+		{
+			case CompressedFormat::BC1:
+			case CompressedFormat::ETC2_RGB:	return 8;
+			default:							return 16;
+		}
+	}
+
+	size_t getCompressedSize(CompressedFormat format, int width, int height)
+	{
+		return (size_t)((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+	}
+
+	const char* getFormatName(CompressedFormat format)
+	{
+		switch (format)
+		{
+			case CompressedFormat::BC1:			return "BC1";
+			case CompressedFormat::BC3:			return "BC3";
+			case CompressedFormat::BC7:			return "BC7";
+			case CompressedFormat::ETC2_RGB:	return "ETC2 RGB";
+			case CompressedFormat::ETC2_RGBA:	return "ETC2 RGBA";
+			case CompressedFormat::ASTC_4X4:	return "ASTC 4x4";
+		}
+
+		return "unknown";
+	}
+
+	bool compressImage(const unsigned char* pixels, int width, int height, CompressedFormat format, std::vector<unsigned char>& output)
+	{
+		void (*encode)(const unsigned char*, unsigned char*) = nullptr;
+
+		switch (format)
+		{
+			case CompressedFormat::BC1: encode = encodeBC1Block; break;
+			case CompressedFormat::BC3: encode = encodeBC3Block; break;
+			case CompressedFormat::BC7: encode = encodeBC7Block; break;
+			default: return false;
+		}
+
+		size_t blockSize = getBlockSize(format);
+		output.resize(getCompressedSize(format, width, height));
+
+		unsigned char* block = output.data();
+		unsigned char texels[64];
+
+		for (int blockY = 0; blockY < height; blockY += 4)
+		{
+			for (int blockX = 0; blockX < width; blockX += 4)
+			{
+				for (int y = 0; y < 4; y++)
+				{
+					int sourceY = blockY + y < height ? blockY + y : height - 1;
+
+					for (int x = 0; x < 4; x++)
+					{
+						int sourceX = blockX + x < width ? blockX + x : width - 1;
+						memcpy(texels + (y * 4 + x) * 4, pixels + ((size_t)sourceY * width + sourceX) * 4, 4);
+					}
+				}
+
+				encode(texels, block);
+				block += blockSize;
+			}
+		}
+
+		return true;
+	}
+
+	bool decompressImage(const unsigned char* data, int width, int height, CompressedFormat format, std::vector<unsigned char>& pixels)
+	{
+		void (*decode)(const unsigned char*, unsigned char*) = nullptr;
+
+		switch (format)
+		{
+			case CompressedFormat::BC1: decode = decodeBC1Block; break;
+			case CompressedFormat::BC3: decode = decodeBC3Block; break;
+			case CompressedFormat::BC7: decode = decodeBC7Block; break;
+			default: return false;
+		}
+
+		size_t blockSize = getBlockSize(format);
+		pixels.resize((size_t)width * height * 4);
+
+		const unsigned char* block = data;
+		unsigned char texels[64];
+
+		for (int blockY = 0; blockY < height; blockY += 4)
+		{
+			for (int blockX = 0; blockX < width; blockX += 4)
+			{
+				decode(block, texels);
+				block += blockSize;
+
+				for (int y = 0; y < 4 && blockY + y < height; y++)
+				{
+					for (int x = 0; x < 4 && blockX + x < width; x++)
+						memcpy(&pixels[((size_t)(blockY + y) * width + blockX + x) * 4], texels + (y * 4 + x) * 4, 4);
+				}
+			}
+		}
+
+		return true;
+	}
+}
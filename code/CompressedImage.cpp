@@ -0,0 +1,548 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "CompressedImage.h"
+#include "Mipmap.h"
+
+namespace mg
+{
+	static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+	static const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+	// In dwReserved1[7] of the header, tools put their own marks in these
+	static const size_t DDS_ORIENTATION_OFFSET = 60;
+	static const char DDS_BOTTOM_UP[] = "MGBU";
+
+	static uint32_t makeFourCC(const char* code)
+	{
+		return code[0] | (code[1] << 8) | (code[2] << 16) | ((uint32_t)code[3] << 24);
+	}
+
+	// Little endian reads and writes, containers are little endian
+
+	static uint32_t read32(const std::vector<unsigned char>& file, size_t offset)
+	{
+		uint32_t value;
+		memcpy(&value, file.data() + offset, sizeof(value));
+		return value;
+	}
+
+	static uint64_t read64(const std::vector<unsigned char>& file, size_t offset)
+	{
+		uint64_t value;
+		memcpy(&value, file.data() + offset, sizeof(value));
+		return value;
+	}
+
+	static void write32(std::vector<unsigned char>& file, uint32_t value)
+	{
+		file.insert(file.end(), (unsigned char*)&value, (unsigned char*)&value + sizeof(value));
+	}
+
+	static void write64(std::vector<unsigned char>& file, uint64_t value)
+	{
+		file.insert(file.end(), (unsigned char*)&value, (unsigned char*)&value + sizeof(value));
+	}
+
+	static void pad(std::vector<unsigned char>& file, size_t alignment)
+	{
+		while (file.size() % alignment)
+			file.push_back(0);
+	}
+
+	static bool readFile(const std::string& path, std::vector<unsigned char>& contents)
+	{
+		std::ifstream stream(path, std::ios::binary | std::ios::ate);
+
+		if (!stream)
+			return false;
+
+		contents.resize((size_t)stream.tellg());
+		stream.seekg(0);
+		stream.read((char*)contents.data(), contents.size());
+
+		return (bool)stream;
+	}
+
+	static bool writeFile(const std::string& path, const std::vector<unsigned char>& contents)
+	{
+		std::ofstream stream(path, std::ios::binary);
+		stream.write((const char*)contents.data(), contents.size());
+
+		if (!stream)
+		{
+			std::cout << "Failed to write " << path << "!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	void addCompressedLevel(CompressedImage& image, const std::vector<unsigned char>& levelData, int levelWidth, int levelHeight)
+	{
+		image.levels.push_back({ levelWidth, levelHeight, image.data.size(), levelData.size() });
+		image.data.insert(image.data.end(), levelData.begin(), levelData.end());
+	}
+
+	// Level table of an image whose levels are stored back to back from level 0
+	static bool layoutLevels(CompressedImage& image, unsigned int levelCount, size_t dataSize)
+	{
+		size_t offset = 0;
+
+		for (unsigned int level = 0; level < levelCount; level++)
+		{
+			int levelWidth = getMipSize(image.width, level);
+			int levelHeight = getMipSize(image.height, level);
+			size_t size = getCompressedSize(image.format, levelWidth, levelHeight);
+
+			if (offset + size > dataSize)
+				return false;
+
+			image.levels.push_back({ levelWidth, levelHeight, offset, size });
+			offset += size;
+		}
+
+		return true;
+	}
+
+	// DDS
+
+	static bool loadDDS(const std::string& path, const std::vector<unsigned char>& file, CompressedImage& image)
+	{
+		if (file.size() < 128)
+			return false;
+
+		image.height = (int)read32(file, 12);
+		image.width = (int)read32(file, 16);
+
+		unsigned int levelCount = read32(file, 28);
+		levelCount = levelCount ? levelCount : 1;
+
+		uint32_t fourCC = read32(file, 84);
+		size_t dataOffset = 128;
+
+		image.srgb = false;
+		image.bottomUp = read32(file, DDS_ORIENTATION_OFFSET) == makeFourCC(DDS_BOTTOM_UP);
+
+		if (fourCC == makeFourCC("DXT1"))
+		{
+			image.format = CompressedFormat::BC1;
+		}
+		else if (fourCC == makeFourCC("DXT5"))
+		{
+			image.format = CompressedFormat::BC3;
+		}
+		else if (fourCC == makeFourCC("DX10") && file.size() >= 148)
+		{
+			dataOffset = 148;
+
+			switch (read32(file, 128))
+			{
+				case 71: image.format = CompressedFormat::BC1; break;
+				case 72: image.format = CompressedFormat::BC1; image.srgb = true; break;
+				case 77: image.format = CompressedFormat::BC3; break;
+				case 78: image.format = CompressedFormat::BC3; image.srgb = true; break;
+				case 98: image.format = CompressedFormat::BC7; break;
+				case 99: image.format = CompressedFormat::BC7; image.srgb = true; break;
+
+				default:
+					std::cout << "DDS format of " << path << " is not supported!" << std::endl;
+					return false;
+			}
+		}
+		else
+		{
+			std::cout << "DDS format of " << path << " is not supported!" << std::endl;
+			return false;
+		}
+
+		image.data.assign(file.begin() + dataOffset, file.end());
+
+		return layoutLevels(image, levelCount, image.data.size());
+	}
+
+	bool saveDDS(const std::string& path, const CompressedImage& image)
+	{
+		uint32_t dxgiFormat;
+
+		switch (image.format)
+		{
+			case CompressedFormat::BC1: dxgiFormat = image.srgb ? 72 : 71; break;
+			case CompressedFormat::BC3: dxgiFormat = image.srgb ? 78 : 77; break;
+			case CompressedFormat::BC7: dxgiFormat = image.srgb ? 99 : 98; break;
+
+			default:
+				std::cout << getFormatName(image.format) << " can not be stored in DDS!" << std::endl;
+				return false;
+		}
+
+		// Old readers only know the four character codes, BC7 and sRGB need the DX10 header
+		bool dx10 = image.format == CompressedFormat::BC7 || image.srgb;
+
+		std::vector<unsigned char> file;
+
+		write32(file, DDS_MAGIC);
+
+		// DDS_HEADER
+		write32(file, 124);
+		write32(file, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000); // CAPS HEIGHT WIDTH PIXELFORMAT MIPMAPCOUNT LINEARSIZE
+		write32(file, image.height);
+		write32(file, image.width);
+		write32(file, (uint32_t)image.levels[0].size);
+		write32(file, 0);
+		write32(file, (uint32_t)image.levels.size());
+
+		for (int i = 0; i < 11; i++)
+			write32(file, 0);
+
+		if (image.bottomUp)
+		{
+			uint32_t mark = makeFourCC(DDS_BOTTOM_UP);
+			memcpy(file.data() + DDS_ORIENTATION_OFFSET, &mark, sizeof(mark));
+		}
+
+		// DDS_PIXELFORMAT
+		write32(file, 32);
+		write32(file, 0x4); // FOURCC
+		write32(file, dx10 ? makeFourCC("DX10") : makeFourCC(image.format == CompressedFormat::BC1 ? "DXT1" : "DXT5"));
+
+		for (int i = 0; i < 5; i++)
+			write32(file, 0);
+
+		// TEXTURE, and COMPLEX MIPMAP with more than one level
+		write32(file, image.levels.size() > 1 ? 0x1000 | 0x400000 | 0x8 : 0x1000);
+
+		for (int i = 0; i < 4; i++)
+			write32(file, 0);
+
+		if (dx10)
+		{
+			write32(file, dxgiFormat);
+			write32(file, 3); // TEXTURE2D
+			write32(file, 0);
+			write32(file, 1);
+			write32(file, 0);
+		}
+
+		file.insert(file.end(), image.data.begin(), image.data.end());
+
+		return writeFile(path, file);
+	}
+
+	// KTX2
+
+	static bool fromVkFormat(uint32_t vkFormat, CompressedImage& image)
+	{
+		// UNORM and SRGB variants are next to each other
+		image.srgb = false;
+
+		switch (vkFormat)
+		{
+			case 132: case 134: case 138: case 146: case 148: case 152: case 158:
+				image.srgb = true;
+				vkFormat--;
+				break;
+		}
+
+		switch (vkFormat)
+		{
+			case 131: case 133:	image.format = CompressedFormat::BC1; return true;
+			case 137:			image.format = CompressedFormat::BC3; return true;
+			case 145:			image.format = CompressedFormat::BC7; return true;
+			case 147:			image.format = CompressedFormat::ETC2_RGB; return true;
+			case 151:			image.format = CompressedFormat::ETC2_RGBA; return true;
+			case 157:			image.format = CompressedFormat::ASTC_4X4; return true;
+		}
+
+		return false;
+	}
+
+	static uint32_t toVkFormat(const CompressedImage& image)
+	{
+		uint32_t vkFormat = 0;
+
+		switch (image.format)
+		{
+			case CompressedFormat::BC1:			vkFormat = 133; break;
+			case CompressedFormat::BC3:			vkFormat = 137; break;
+			case CompressedFormat::BC7:			vkFormat = 145; break;
+			case CompressedFormat::ETC2_RGB:	vkFormat = 147; break;
+			case CompressedFormat::ETC2_RGBA:	vkFormat = 151; break;
+			case CompressedFormat::ASTC_4X4:	vkFormat = 157; break;
+		}
+
+		return vkFormat + (image.srgb ? 1 : 0);
+	}
+
+	static bool loadKTX2(const std::string& path, const std::vector<unsigned char>& file, CompressedImage& image)
+	{
+		if (file.size() < 80)
+			return false;
+
+		if (!fromVkFormat(read32(file, 12), image))
+		{
+			std::cout << "KTX2 format " << read32(file, 12) << " of " << path << " is not supported!" << std::endl;
+			return false;
+		}
+
+		image.width = (int)read32(file, 20);
+		image.height = (int)read32(file, 24);
+
+		uint32_t depth = read32(file, 28);
+		uint32_t layers = read32(file, 32);
+		uint32_t faces = read32(file, 36);
+		uint32_t levelCount = read32(file, 40);
+		uint32_t supercompression = read32(file, 44);
+
+		if (depth > 1 || layers > 1 || faces != 1)
+		{
+			std::cout << path << " is not a 2D texture!" << std::endl;
+			return false;
+		}
+
+		if (supercompression != 0)
+		{
+			std::cout << "Supercompressed KTX2 files like " << path << " are not supported!" << std::endl;
+			return false;
+		}
+
+		// 0 asks the loader to generate mipmaps, there is only level 0
+		levelCount = levelCount ? levelCount : 1;
+
+		// Top first unless KTXorientation says rows go up
+		image.bottomUp = false;
+
+		uint32_t keyValueOffset = read32(file, 56);
+		uint32_t keyValueLength = read32(file, 60);
+
+		if ((uint64_t)keyValueOffset + keyValueLength > file.size())
+			return false;
+
+		for (uint32_t position = keyValueOffset; position + 4 <= keyValueOffset + keyValueLength; )
+		{
+			uint32_t length = read32(file, position);
+			const char* entry = (const char*)file.data() + position + 4;
+
+			if (length > keyValueOffset + keyValueLength - position - 4)
+				break;
+
+			// Key and value are null terminated, the value is e.g. "rd"
+			const char key[] = "KTXorientation";
+
+			if (length > sizeof(key) + 1 && memcmp(entry, key, sizeof(key)) == 0)
+				image.bottomUp = entry[sizeof(key) + 1] == 'u';
+
+			// Entries are padded to 4 bytes, the padding is not in the length
+			position += 4 + ((length + 3) & ~3u);
+		}
+
+		if (file.size() < 80 + levelCount * 24)
+			return false;
+
+		// Level data is usually stored smallest first, copy it in level order
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			uint64_t offset = read64(file, 80 + level * 24);
+			uint64_t length = read64(file, 80 + level * 24 + 8);
+
+			int levelWidth = getMipSize(image.width, level);
+			int levelHeight = getMipSize(image.height, level);
+
+			if (offset + length > file.size() || length < getCompressedSize(image.format, levelWidth, levelHeight))
+				return false;
+
+			image.levels.push_back({ levelWidth, levelHeight, image.data.size(), (size_t)length });
+			image.data.insert(image.data.end(), file.begin() + offset, file.begin() + offset + length);
+		}
+
+		return true;
+	}
+
+	// Basic data format descriptor, readers need it to know the block layout
+	static void writeDataFormatDescriptor(std::vector<unsigned char>& file, const CompressedImage& image)
+	{
+		struct Sample
+		{
+			uint32_t bitOffset;
+			uint32_t bitLength;
+			uint32_t channel;
+		};
+
+		uint32_t colorModel;
+		uint32_t sampleCount = 1;
+		Sample samples[2] = {};
+
+		switch (image.format)
+		{
+			// BC1A, channel 1 is color with alpha
+			case CompressedFormat::BC1: colorModel = 128; samples[0] = { 0, 64, 1 }; break;
+			case CompressedFormat::BC7: colorModel = 134; samples[0] = { 0, 128, 0 }; break;
+			case CompressedFormat::ETC2_RGB: colorModel = 161; samples[0] = { 0, 64, 2 }; break;
+			case CompressedFormat::ASTC_4X4: colorModel = 162; samples[0] = { 0, 128, 0 }; break;
+
+			// Alpha block first, then color
+			case CompressedFormat::BC3: colorModel = 130; break;
+			case CompressedFormat::ETC2_RGBA: colorModel = 161; break;
+
+			default: return;
+		}
+
+		// Color is channel 0 for BC3, ETC2 names it channel 2
+		if (image.format == CompressedFormat::BC3 || image.format == CompressedFormat::ETC2_RGBA)
+		{
+			sampleCount = 2;
+			samples[0] = { 0, 64, 15 };
+			samples[1] = { 64, 64, image.format == CompressedFormat::ETC2_RGBA ? 2u : 0u };
+		}
+
+		uint32_t blockSize = 24 + 16 * sampleCount;
+
+		write32(file, 4 + blockSize);
+
+		// Vendor Khronos, basic descriptor, version 2
+		write32(file, 0);
+		write32(file, 2 | (blockSize << 16));
+
+		// Model, BT.709 primaries, linear or sRGB transfer, straight alpha
+		write32(file, colorModel | (1 << 8) | ((image.srgb ? 2 : 1) << 16));
+
+		// 4x4 blocks, dimensions minus one
+		write32(file, 3 | (3 << 8));
+
+		// Bytes per block in plane 0
+		write32(file, (uint32_t)getBlockSize(image.format));
+		write32(file, 0);
+
+		for (uint32_t i = 0; i < sampleCount; i++)
+		{
+			const Sample& sample = samples[i];
+			write32(file, sample.bitOffset | ((sample.bitLength - 1) << 16) | (sample.channel << 24));
+			write32(file, 0);
+			write32(file, 0);
+			write32(file, 0xFFFFFFFF);
+		}
+	}
+
+	bool saveKTX2(const std::string& path, const CompressedImage& image)
+	{
+		uint32_t levelCount = (uint32_t)image.levels.size();
+
+		std::vector<unsigned char> file(KTX2_IDENTIFIER, KTX2_IDENTIFIER + sizeof(KTX2_IDENTIFIER));
+
+		write32(file, toVkFormat(image));
+		write32(file, 1);
+		write32(file, image.width);
+		write32(file, image.height);
+		write32(file, 0);
+		write32(file, 0);
+		write32(file, 1);
+		write32(file, levelCount);
+		write32(file, 0);
+
+		// Index is filled once the sections are laid out
+		size_t indexOffset = file.size();
+		file.resize(file.size() + 32 + levelCount * 24);
+
+		std::vector<unsigned char> descriptor;
+		writeDataFormatDescriptor(descriptor, image);
+
+		uint32_t descriptorOffset = (uint32_t)file.size();
+		file.insert(file.end(), descriptor.begin(), descriptor.end());
+
+		// Right, then up when rows are stored bottom first
+		const char key[] = "KTXorientation";
+		const char* value = image.bottomUp ? "ru" : "rd";
+
+		std::vector<unsigned char> keyValues;
+		write32(keyValues, sizeof(key) + 3);
+		keyValues.insert(keyValues.end(), key, key + sizeof(key));
+		keyValues.insert(keyValues.end(), value, value + 3);
+		pad(keyValues, 4);
+
+		uint32_t keyValueOffset = (uint32_t)file.size();
+		uint32_t keyValueLength = (uint32_t)keyValues.size();
+		file.insert(file.end(), keyValues.begin(), keyValues.end());
+
+		// Smallest level first, each aligned to a block
+		std::vector<uint64_t> levelOffsets(levelCount);
+
+		for (uint32_t level = levelCount; level-- > 0; )
+		{
+			pad(file, getBlockSize(image.format));
+
+			levelOffsets[level] = file.size();
+			file.insert(file.end(), image.getLevelData(level), image.getLevelData(level) + image.levels[level].size);
+		}
+
+		std::vector<unsigned char> index;
+		write32(index, descriptorOffset);
+		write32(index, (uint32_t)descriptor.size());
+		write32(index, keyValueOffset);
+		write32(index, keyValueLength);
+		write64(index, 0);
+		write64(index, 0);
+
+		for (uint32_t level = 0; level < levelCount; level++)
+		{
+			write64(index, levelOffsets[level]);
+			write64(index, image.levels[level].size);
+
+			// Same as the length without supercompression
+			write64(index, image.levels[level].size);
+		}
+
+		memcpy(file.data() + indexOffset, index.data(), index.size());
+
+		return writeFile(path, file);
+	}
+
+	bool isCompressedImageFile(const std::string& path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+
+		for (char& character : extension)
+			character = (char)tolower(character);
+
+		return extension == ".dds" || extension == ".ktx2";
+	}
+
+	bool loadCompressedImage(const std::string& path, CompressedImage& image)
+	{
+		std::vector<unsigned char> file;
+
+		if (!readFile(path, file))
+		{
+			std::cout << "Failed to open " << path << "!" << std::endl;
+			return false;
+		}
+
+		image.levels.clear();
+		image.data.clear();
+
+		bool loaded = false;
+
+		if (file.size() >= 12 && memcmp(file.data(), KTX2_IDENTIFIER, 12) == 0)
+			loaded = loadKTX2(path, file, image);
+		else if (file.size() >= 4 && read32(file, 0) == DDS_MAGIC)
+			loaded = loadDDS(path, file, image);
+		else
+			std::cout << path << " is not a DDS or KTX2 file!" << std::endl;
+
+		if (!loaded || image.levels.empty())
+		{
+			std::cout << "Failed to load compressed image " << path << "!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+}
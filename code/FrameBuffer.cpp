@@ -0,0 +1,77 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "FrameBuffer.h"
+#include "GLStateCache.h"
+
+namespace mg
+{
+	FrameBuffer::FrameBuffer(int width, int height)
+		: width(width), height(height), complete(false)
+	{
+		glGenTextures(1, &colorTexture);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, colorTexture);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+
+		glGenRenderbuffers(1, &depthStencil);
+		glBindRenderbuffer(GL_RENDERBUFFER, depthStencil);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		glGenFramebuffers(1, &id);
+		glBindFramebuffer(GL_FRAMEBUFFER, id);
+
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencil);
+
+		complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+		if (!complete)
+			std::cout << "Framebuffer of " << width << "x" << height << " is not complete!" << std::endl;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	FrameBuffer::~FrameBuffer()
+	{
+		glDeleteFramebuffers(1, &id);
+		glDeleteRenderbuffers(1, &depthStencil);
+		GLStateCache::deleteTexture(colorTexture);
+	}
+
+	void FrameBuffer::bind()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, id);
+		glViewport(0, 0, width, height);
+	}
+
+	void FrameBuffer::unbind()
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	void FrameBuffer::readPixels(std::vector<unsigned char>& pixels)
+	{
+		pixels.resize((size_t)width * height * 4);
+
+		// Into client memory, not into a pack buffer left bound
+		GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, id);
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	}
+}
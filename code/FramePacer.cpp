@@ -0,0 +1,120 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#endif
+
+#include "FramePacer.h"
+#include "Profiler.h"
+
+using namespace std::chrono;
+
+namespace mg
+{
+	// Longest frame fed to the smoothed delta time, a breakpoint or a
+	// window drag should not launch the simulation forward
+	static constexpr float MAX_DELTA_TIME = 0.25f;
+
+	// Past this many sleeps older ones fade out, the estimate follows
+	// changes in system load
+	static constexpr long long MAX_SLEEP_SAMPLES = 1000;
+
+	FramePacer::FramePacer(FramePacing mode, float targetRate)
+		: mode(mode), rawDeltaTime(1.0f / targetRate), deltaTime(1.0f / targetRate), smoothing(0.1f),
+		  sleepMean(0.005), sleepVariance(0.0), sleepCount(1)
+	{
+#ifdef _WIN32
+		// Sleeps last a whole 15.6 ms tick by default
+		timeBeginPeriod(1);
+#endif
+
+		setTargetRate(targetRate);
+	}
+
+	FramePacer::~FramePacer()
+	{
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+	}
+
+	void FramePacer::setMode(FramePacing pacing)
+	{
+		mode = pacing;
+
+		// Start counting from now instead of from a deadline long gone
+		frameStart = Clock::now();
+		deadline = frameStart + targetInterval;
+	}
+
+	void FramePacer::setTargetRate(float framesPerSecond)
+	{
+		targetInterval = duration_cast<Clock::duration>(duration<double>(1.0 / framesPerSecond));
+
+		frameStart = Clock::now();
+		deadline = frameStart + targetInterval;
+	}
+
+	void FramePacer::endFrame()
+	{
+		if (mode == FramePacing::CAPPED)
+		{
+			// More than a whole frame late, catching up would run frames
+			// back to back so the schedule starts over instead
+			if (Clock::now() > deadline + targetInterval)
+				deadline = Clock::now();
+			else
+				waitUntil(deadline);
+		}
+
+		Clock::time_point frameEnd = Clock::now();
+
+		rawDeltaTime = duration<float>(frameEnd - frameStart).count();
+		deltaTime += (std::min(rawDeltaTime, MAX_DELTA_TIME) - deltaTime) * smoothing;
+
+		frameStart = frameEnd;
+
+		// Absolute, a late wake up shortens the next wait
+		if (mode == FramePacing::CAPPED)
+			deadline += targetInterval;
+		else
+			deadline = frameEnd + targetInterval;
+	}
+
+	void FramePacer::waitUntil(Clock::time_point time)
+	{
+		ProfileScope profile("FramePacer::wait");
+
+		// Sleep in short steps while the worst expected overshoot still fits
+		double estimate = sleepMean + std::sqrt(sleepVariance);
+
+		while (duration<double>(time - Clock::now()).count() > estimate)
+		{
+			Clock::time_point sleepStart = Clock::now();
+			std::this_thread::sleep_for(milliseconds(1));
+			double slept = duration<double>(Clock::now() - sleepStart).count();
+
+			// Welford's running mean and variance
+			sleepCount = std::min(sleepCount + 1, MAX_SLEEP_SAMPLES);
+			double difference = slept - sleepMean;
+			sleepMean += difference / sleepCount;
+			sleepVariance += (difference * (slept - sleepMean) - sleepVariance) / sleepCount;
+
+			estimate = sleepMean + std::sqrt(sleepVariance);
+		}
+
+		// Spin the rest, only the last one or two milliseconds
+		while (Clock::now() < time)
+			std::this_thread::yield();
+	}
+}
@@ -0,0 +1,133 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include "GLExtensions.h"
+
+namespace mg
+{
+	int GLExtensions::majorVersion = 0;
+	int GLExtensions::minorVersion = 0;
+
+	std::unordered_set<std::string> GLExtensions::extensions;
+
+	bool GLExtensions::hasMultiDrawIndirect = false;
+	PFNGLMULTIDRAWELEMENTSINDIRECTPROC GLExtensions::multiDrawElementsIndirect = nullptr;
+
+	bool GLExtensions::hasBufferStorage = false;
+	PFNGLBUFFERSTORAGEPROC GLExtensions::bufferStorage = nullptr;
+
+	bool GLExtensions::hasProgramBinary = false;
+	PFNGLGETPROGRAMBINARYPROC GLExtensions::getProgramBinary = nullptr;
+	PFNGLPROGRAMBINARYPROC GLExtensions::programBinary = nullptr;
+	PFNGLPROGRAMPARAMETERIPROC GLExtensions::programParameteri = nullptr;
+
+	bool GLExtensions::hasParallelShaderCompile = false;
+	PFNGLMAXSHADERCOMPILERTHREADSKHRPROC GLExtensions::maxShaderCompilerThreads = nullptr;
+
+	bool GLExtensions::hasTextureStorage = false;
+	PFNGLTEXSTORAGE2DPROC GLExtensions::texStorage2D = nullptr;
+	PFNGLTEXSTORAGE3DPROC GLExtensions::texStorage3D = nullptr;
+
+	bool GLExtensions::hasAnisotropicFiltering = false;
+	float GLExtensions::maxAnisotropy = 1.0f;
+
+	bool GLExtensions::hasS3TC = false;
+	bool GLExtensions::hasS3TCsRGB = false;
+	bool GLExtensions::hasBPTC = false;
+	bool GLExtensions::hasETC2 = false;
+	bool GLExtensions::hasASTC = false;
+
+	bool GLExtensions::hasBindlessTexture = false;
+	PFNGLGETTEXTUREHANDLEARBPROC GLExtensions::getTextureHandle = nullptr;
+	PFNGLMAKETEXTUREHANDLERESIDENTARBPROC GLExtensions::makeTextureHandleResident = nullptr;
+	PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC GLExtensions::makeTextureHandleNonResident = nullptr;
+
+	void GLExtensions::load(GLADloadproc loader)
+	{
+		glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+		glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+		int extensionCount = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+
+		extensions.clear();
+
+		for (int i = 0; i < extensionCount; i++)
+			extensions.insert((const char*)glGetStringi(GL_EXTENSIONS, i));
+
+		// Multi draw indirect
+		multiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)loader("glMultiDrawElementsIndirect");
+		hasMultiDrawIndirect = (isVersion(4, 3) || isSupported("GL_ARB_multi_draw_indirect")) && multiDrawElementsIndirect;
+
+		// Immutable buffer storage
+		bufferStorage = (PFNGLBUFFERSTORAGEPROC)loader("glBufferStorage");
+		hasBufferStorage = (isVersion(4, 4) || isSupported("GL_ARB_buffer_storage")) && bufferStorage;
+
+		// Program binaries, some drivers expose the entry points without any format
+		getProgramBinary = (PFNGLGETPROGRAMBINARYPROC)loader("glGetProgramBinary");
+		programBinary = (PFNGLPROGRAMBINARYPROC)loader("glProgramBinary");
+		programParameteri = (PFNGLPROGRAMPARAMETERIPROC)loader("glProgramParameteri");
+
+		int binaryFormats = 0;
+
+		if (isVersion(4, 1) || isSupported("GL_ARB_get_program_binary"))
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+
+		hasProgramBinary = binaryFormats > 0 && getProgramBinary && programBinary && programParameteri;
+
+		// Parallel shader compile, both extensions share the token
+		if (isSupported("GL_KHR_parallel_shader_compile"))
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)loader("glMaxShaderCompilerThreadsKHR");
+		else if (isSupported("GL_ARB_parallel_shader_compile"))
+			maxShaderCompilerThreads = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)loader("glMaxShaderCompilerThreadsARB");
+
+		hasParallelShaderCompile = maxShaderCompilerThreads != nullptr;
+
+		// Let the driver pick how many threads to use
+		if (hasParallelShaderCompile)
+			maxShaderCompilerThreads(0xFFFFFFFF);
+
+		// Immutable texture storage
+		texStorage2D = (PFNGLTEXSTORAGE2DPROC)loader("glTexStorage2D");
+		texStorage3D = (PFNGLTEXSTORAGE3DPROC)loader("glTexStorage3D");
+		hasTextureStorage = (isVersion(4, 2) || isSupported("GL_ARB_texture_storage")) && texStorage2D && texStorage3D;
+
+		// Anisotropic filtering, the core and extension tokens have the same value
+		hasAnisotropicFiltering = isVersion(4, 6) || isSupported("GL_ARB_texture_filter_anisotropic") ||
+			isSupported("GL_EXT_texture_filter_anisotropic");
+
+		maxAnisotropy = 1.0f;
+
+		if (hasAnisotropicFiltering)
+			glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy);
+
+		// Compressed formats, S3TC is missing from some Mesa builds
+		hasS3TC = isSupported("GL_EXT_texture_compression_s3tc");
+		hasS3TCsRGB = hasS3TC && (isVersion(4, 2) || isSupported("GL_EXT_texture_sRGB"));
+		hasBPTC = isVersion(4, 2) || isSupported("GL_ARB_texture_compression_bptc");
+		hasETC2 = isVersion(4, 3) || isSupported("GL_ARB_ES3_compatibility");
+		hasASTC = isSupported("GL_KHR_texture_compression_astc_ldr");
+
+		// Bindless textures, never part of core
+		if (isSupported("GL_ARB_bindless_texture"))
+		{
+			getTextureHandle = (PFNGLGETTEXTUREHANDLEARBPROC)loader("glGetTextureHandleARB");
+			makeTextureHandleResident = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)loader("glMakeTextureHandleResidentARB");
+			makeTextureHandleNonResident = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)loader("glMakeTextureHandleNonResidentARB");
+		}
+
+		hasBindlessTexture = getTextureHandle && makeTextureHandleResident && makeTextureHandleNonResident;
+	}
+
+	bool GLExtensions::isVersion(int major, int minor)
+	{
+		return majorVersion > major || (majorVersion == major && minorVersion >= minor);
+	}
+
+	bool GLExtensions::isSupported(const std::string& extension)
+	{
+		return extensions.find(extension) != extensions.end();
+	}
+}
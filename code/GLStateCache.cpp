@@ -0,0 +1,276 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include "GLStateCache.h"
+#include "GLExtensions.h"
+
+namespace mg
+{
+	// Default state of a new context
+	unsigned int GLStateCache::program = 0;
+	unsigned int GLStateCache::vertexArray = 0;
+	unsigned int GLStateCache::activeTextureUnit = 0;
+
+	unsigned int GLStateCache::buffers[BUFFER_TARGET_COUNT] = { 0 };
+	unsigned int GLStateCache::uniformBindings[UNIFORM_BINDING_COUNT] = { 0 };
+	unsigned int GLStateCache::textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT] = { { 0 } };
+
+	std::unordered_map<unsigned int, unsigned int> GLStateCache::elementBuffers;
+
+	GLStateCounters GLStateCache::counters = {};
+
+	uint64_t GLStateCounters::totalIssued() const
+	{
+		uint64_t total = 0;
+
+		for (uint64_t count : issued)
+			total += count;
+
+		return total;
+	}
+
+	uint64_t GLStateCounters::totalSkipped() const
+	{
+		uint64_t total = 0;
+
+		for (uint64_t count : skipped)
+			total += count;
+
+		return total;
+	}
+
+	void GLStateCache::useProgram(unsigned int id)
+	{
+		if (changed(program, id, GLStateKind::PROGRAM))
+			glUseProgram(id);
+	}
+
+	void GLStateCache::bindVertexArray(unsigned int id)
+	{
+		if (changed(vertexArray, id, GLStateKind::VERTEX_ARRAY))
+			glBindVertexArray(id);
+	}
+
+	void GLStateCache::bindBuffer(unsigned int target, unsigned int id)
+	{
+		// Element buffer binding belongs to the bound vertex array
+		if (target == GL_ELEMENT_ARRAY_BUFFER && vertexArray != UNKNOWN)
+		{
+			auto it = elementBuffers.find(vertexArray);
+
+			if (it != elementBuffers.end() && it->second == id)
+			{
+				counters.skipped[(int)GLStateKind::BUFFER]++;
+				return;
+			}
+
+			elementBuffers[vertexArray] = id;
+			counters.issued[(int)GLStateKind::BUFFER]++;
+			glBindBuffer(target, id);
+			return;
+		}
+
+		int index = bufferTargetIndex(target);
+
+		if (index < 0)
+		{
+			counters.issued[(int)GLStateKind::BUFFER]++;
+			glBindBuffer(target, id);
+			return;
+		}
+
+		if (changed(buffers[index], id, GLStateKind::BUFFER))
+			glBindBuffer(target, id);
+	}
+
+	void GLStateCache::bindBufferBase(unsigned int target, unsigned int index, unsigned int id)
+	{
+		if (target == GL_UNIFORM_BUFFER && index < UNIFORM_BINDING_COUNT)
+		{
+			if (!changed(uniformBindings[index], id, GLStateKind::BUFFER))
+				return;
+		}
+		else
+		{
+			counters.issued[(int)GLStateKind::BUFFER]++;
+		}
+
+		glBindBufferBase(target, index, id);
+
+		int generic = bufferTargetIndex(target);
+
+		if (generic >= 0)
+			buffers[generic] = id;
+	}
+
+	void GLStateCache::activeTexture(unsigned int unit)
+	{
+		if (changed(activeTextureUnit, unit, GLStateKind::TEXTURE_UNIT))
+			glActiveTexture(GL_TEXTURE0 + unit);
+	}
+
+	void GLStateCache::bindTexture(unsigned int unit, unsigned int target, unsigned int id)
+	{
+		int index = textureTargetIndex(target);
+
+		if (index < 0 || unit >= MAX_TEXTURE_UNITS)
+		{
+			activeTexture(unit);
+			counters.issued[(int)GLStateKind::TEXTURE]++;
+			glBindTexture(target, id);
+			return;
+		}
+
+		// Check before touching the active unit so a redundant bind costs nothing
+		if (textures[unit][index] == id)
+		{
+			counters.skipped[(int)GLStateKind::TEXTURE]++;
+			return;
+		}
+
+		activeTexture(unit);
+		changed(textures[unit][index], id, GLStateKind::TEXTURE);
+		glBindTexture(target, id);
+	}
+
+	void GLStateCache::bindTexture(unsigned int target, unsigned int id)
+	{
+		if (activeTextureUnit == UNKNOWN)
+			activeTexture(0);
+
+		bindTexture(activeTextureUnit, target, id);
+	}
+
+	void GLStateCache::deleteProgram(unsigned int id)
+	{
+		glDeleteProgram(id);
+
+		// Program stays installed until another one is used, but its name can
+		// be handed out again so a later bind must not be skipped
+		if (program == id)
+			program = UNKNOWN;
+	}
+
+	void GLStateCache::deleteVertexArray(unsigned int id)
+	{
+		glDeleteVertexArrays(1, &id);
+
+		elementBuffers.erase(id);
+
+		if (vertexArray == id)
+			vertexArray = 0;
+	}
+
+	void GLStateCache::deleteBuffer(unsigned int id)
+	{
+		glDeleteBuffers(1, &id);
+
+		for (unsigned int& buffer : buffers)
+		{
+			if (buffer == id)
+				buffer = 0;
+		}
+
+		// Not every driver resets indexed bindings of a deleted buffer
+		for (unsigned int& buffer : uniformBindings)
+		{
+			if (buffer == id)
+				buffer = UNKNOWN;
+		}
+
+		// Other vertex arrays may still reference it, make them unknown
+		for (auto it = elementBuffers.begin(); it != elementBuffers.end();)
+		{
+			if (it->second == id)
+				it = elementBuffers.erase(it);
+			else
+				++it;
+		}
+	}
+
+	void GLStateCache::deleteTexture(unsigned int id)
+	{
+		glDeleteTextures(1, &id);
+
+		for (auto& unit : textures)
+		{
+			for (unsigned int& texture : unit)
+			{
+				if (texture == id)
+					texture = 0;
+			}
+		}
+	}
+
+	void GLStateCache::invalidate()
+	{
+		program = UNKNOWN;
+		vertexArray = UNKNOWN;
+		activeTextureUnit = UNKNOWN;
+
+		for (unsigned int& buffer : buffers)
+			buffer = UNKNOWN;
+
+		for (unsigned int& buffer : uniformBindings)
+			buffer = UNKNOWN;
+
+		for (auto& unit : textures)
+		{
+			for (unsigned int& texture : unit)
+				texture = UNKNOWN;
+		}
+
+		elementBuffers.clear();
+	}
+
+	void GLStateCache::resetCounters()
+	{
+		counters = {};
+	}
+
+	int GLStateCache::bufferTargetIndex(unsigned int target)
+	{
+		switch (target)
+		{
+			case GL_ARRAY_BUFFER:		 return 0;
+			case GL_UNIFORM_BUFFER:		 return 1;
+			case GL_PIXEL_UNPACK_BUFFER: return 2;
+			case GL_PIXEL_PACK_BUFFER:	 return 3;
+			case GL_COPY_READ_BUFFER:	 return 4;
+			case GL_COPY_WRITE_BUFFER:	 return 5;
+			case GL_TEXTURE_BUFFER:		 return 6;
+			case GL_DRAW_INDIRECT_BUFFER: return 7;
+		}
+
+		return -1;
+	}
+
+	int GLStateCache::textureTargetIndex(unsigned int target)
+	{
+		switch (target)
+		{
+			case GL_TEXTURE_2D:		  return 0;
+			case GL_TEXTURE_2D_ARRAY: return 1;
+			case GL_TEXTURE_CUBE_MAP: return 2;
+		}
+
+		return -1;
+	}
+
+	bool GLStateCache::changed(unsigned int& current, unsigned int id, GLStateKind kind)
+	{
+		if (current == id)
+		{
+			counters.skipped[(int)kind]++;
+			return false;
+		}
+
+		current = id;
+		counters.issued[(int)kind]++;
+		return true;
+	}
+}
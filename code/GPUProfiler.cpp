@@ -0,0 +1,179 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <iomanip>
+#include <sstream>
+
+#include "GPUProfiler.h"
+#include "Profiler.h"
+
+namespace mg
+{
+	GPUProfiler* GPUProfiler::current = nullptr;
+
+	GPUProfiler::GPUProfiler()
+		: frames(), frameIndex(0), inFrame(false), depth(0), frameMilliseconds(0.0), skippedFrames(0),
+		  track(Profiler::createTrack("GPU"))
+	{
+		current = this;
+	}
+
+	GPUProfiler::~GPUProfiler()
+	{
+		for (Frame& frame : frames)
+		{
+			if (!frame.queries.empty())
+				glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+		}
+
+		if (current == this)
+			current = nullptr;
+	}
+
+	void GPUProfiler::beginFrame()
+	{
+		Frame& frame = frames[frameIndex % FRAME_LATENCY];
+
+		if (frame.pending)
+			readBack(frame);
+
+		frame.zones.clear();
+		frame.traced = Profiler::isRecording();
+
+		// Time the GPU reaches the commands issued so far, close enough to
+		// line up GPU sections with the CPU zones that issued them
+		if (frame.traced)
+		{
+			GLint64 gpuTime;
+			glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+
+			frame.clockOffset = (int64_t)Profiler::now() - gpuTime;
+		}
+
+		inFrame = true;
+		depth = 0;
+
+		beginZone("GPU frame");
+	}
+
+	void GPUProfiler::endFrame()
+	{
+		if (!inFrame)
+			return;
+
+		endZone(0);
+
+		Frame& frame = frames[frameIndex % FRAME_LATENCY];
+		frame.pending = true;
+
+		inFrame = false;
+		frameIndex++;
+	}
+
+	unsigned int GPUProfiler::beginZone(const char* name)
+	{
+		if (!inFrame)
+			return MAX_ZONES;
+
+		Frame& frame = frames[frameIndex % FRAME_LATENCY];
+		unsigned int zone = (unsigned int)frame.zones.size();
+
+		if (zone == MAX_ZONES)
+			return MAX_ZONES;
+
+		// Queries are kept from frame to frame, only new ones are generated
+		if (frame.queries.size() < (zone + 1) * 2)
+		{
+			size_t first = frame.queries.size();
+			frame.queries.resize((zone + 1) * 2);
+
+			glGenQueries((GLsizei)(frame.queries.size() - first), frame.queries.data() + first);
+		}
+
+		frame.zones.push_back({ name, depth++ });
+		glQueryCounter(frame.queries[zone * 2], GL_TIMESTAMP);
+
+		return zone;
+	}
+
+	void GPUProfiler::endZone(unsigned int zone)
+	{
+		// Scopes do not span frames, a zone of an ended frame is not measured
+		if (!inFrame || zone >= MAX_ZONES)
+			return;
+
+		Frame& frame = frames[frameIndex % FRAME_LATENCY];
+		glQueryCounter(frame.queries[zone * 2 + 1], GL_TIMESTAMP);
+
+		depth--;
+	}
+
+	std::string GPUProfiler::getSummary() const
+	{
+		std::ostringstream summary;
+		summary << std::fixed << std::setprecision(3) << "GPU " << frameMilliseconds << " ms";
+
+		// Sections with the same name and depth, like every draw, add up
+		std::vector<GPUZoneResult> totals;
+
+		for (size_t i = 1; i < results.size(); i++)
+		{
+			const GPUZoneResult& result = results[i];
+			bool found = false;
+
+			for (GPUZoneResult& total : totals)
+			{
+				if (total.depth == result.depth && std::string(total.name) == result.name)
+				{
+					total.milliseconds += result.milliseconds;
+					found = true;
+				}
+			}
+
+			if (!found)
+				totals.push_back(result);
+		}
+
+		for (size_t i = 0; i < totals.size(); i++)
+			summary << (i == 0 ? ": " : ", ") << totals[i].name << " " << totals[i].milliseconds << " ms";
+
+		return summary.str();
+	}
+
+	void GPUProfiler::readBack(Frame& frame)
+	{
+		frame.pending = false;
+
+		// End of the frame is the last timestamp written, once it is
+		// available every other one of the frame is too
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available)
+		{
+			skippedFrames++;
+			return;
+		}
+
+		results.clear();
+
+		for (size_t i = 0; i < frame.zones.size(); i++)
+		{
+			GLuint64 begin, end;
+			glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+			const Zone& zone = frame.zones[i];
+			results.push_back({ zone.name, zone.depth, (end - begin) / 1000000.0 });
+
+			if (frame.traced)
+				Profiler::record(track, zone.name, begin + frame.clockOffset, end + frame.clockOffset);
+		}
+
+		frameMilliseconds = results[0].milliseconds;
+	}
+}
@@ -0,0 +1,217 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <SFML/Window/Context.hpp>
+#endif
+
+#include "HeadlessContext.h"
+
+namespace mg
+{
+#ifdef __linux__
+	static bool hasExtension(const char* extensions, const char* name)
+	{
+		if (!extensions)
+			return false;
+
+		size_t length = strlen(name);
+
+		// Whole names only, some extensions are prefixes of others
+		for (const char* found = strstr(extensions, name); found; found = strstr(found + length, name))
+		{
+			bool startsName = found == extensions || found[-1] == ' ';
+			bool endsName = found[length] == ' ' || found[length] == '\0';
+
+			if (startsName && endsName)
+				return true;
+		}
+
+		return false;
+	}
+#endif
+
+	HeadlessContext::HeadlessContext()
+		: display(nullptr), context(nullptr), surface(nullptr)
+	{
+	}
+
+	HeadlessContext::~HeadlessContext()
+	{
+		destroy();
+	}
+
+	bool HeadlessContext::create(int majorVersion, int minorVersion)
+	{
+#ifdef __linux__
+		destroy();
+
+		// Surfaceless needs neither an X server nor a DRM device
+		const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+		EGLDisplay eglDisplay = EGL_NO_DISPLAY;
+
+		if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+		{
+			auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+			if (getPlatformDisplay)
+				eglDisplay = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		}
+
+		if (eglDisplay == EGL_NO_DISPLAY)
+			eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+		EGLint major, minor;
+
+		if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, &major, &minor))
+		{
+			std::cout << "Could not initialize an EGL display!" << std::endl;
+			return false;
+		}
+
+		display = eglDisplay;
+
+		if (!eglBindAPI(EGL_OPENGL_API))
+		{
+			std::cout << "EGL display does not support desktop OpenGL!" << std::endl;
+			destroy();
+			return false;
+		}
+
+		const char* extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+		bool surfaceless = hasExtension(extensions, "EGL_KHR_surfaceless_context");
+
+		const EGLint configAttributes[] =
+		{
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+			EGL_NONE
+		};
+
+		EGLConfig config = nullptr;
+		EGLint configCount = 0;
+
+		eglChooseConfig(eglDisplay, configAttributes, &config, 1, &configCount);
+
+		// The surfaceless platform has no pbuffer configs, contexts go without one
+		if (configCount == 0)
+		{
+			if (!surfaceless || !hasExtension(extensions, "EGL_KHR_no_config_context"))
+			{
+				std::cout << "No EGL config for an offscreen OpenGL context!" << std::endl;
+				destroy();
+				return false;
+			}
+
+			config = EGL_NO_CONFIG_KHR;
+		}
+
+		const EGLint contextAttributes[] =
+		{
+			EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+			EGL_CONTEXT_MINOR_VERSION, minorVersion,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+
+		context = eglCreateContext(eglDisplay, config, EGL_NO_CONTEXT, contextAttributes);
+
+		if (!context)
+		{
+			std::cout << "Could not create an OpenGL " << majorVersion << "." << minorVersion << " core context with EGL!" << std::endl;
+			destroy();
+			return false;
+		}
+
+		// Rendering goes to framebuffer objects, the surface is only there
+		// for drivers that need one to make the context current
+		if (!surfaceless)
+		{
+			const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+			surface = eglCreatePbufferSurface(eglDisplay, config, surfaceAttributes);
+
+			if (!surface)
+			{
+				std::cout << "Could not create an EGL pbuffer surface!" << std::endl;
+				destroy();
+				return false;
+			}
+		}
+
+		EGLSurface eglSurface = surface ? (EGLSurface)surface : EGL_NO_SURFACE;
+
+		if (!eglMakeCurrent(eglDisplay, eglSurface, eglSurface, (EGLContext)context))
+		{
+			std::cout << "Could not make the EGL context current!" << std::endl;
+			destroy();
+			return false;
+		}
+
+		return true;
+#else
+		destroy();
+
+		// SFML makes it current on a hidden window, WGL on Windows
+		sf::ContextSettings settings(24, 8, 0, majorVersion, minorVersion, sf::ContextSettings::Core);
+		sf::Context* sfmlContext = new sf::Context(settings, 1, 1);
+
+		// SFML falls back to any version it can get instead of failing
+		const sf::ContextSettings& created = sfmlContext->getSettings();
+
+		if ((int)(created.majorVersion * 10 + created.minorVersion) < majorVersion * 10 + minorVersion)
+		{
+			std::cout << "Could not create an OpenGL " << majorVersion << "." << minorVersion << " core context, got "
+				<< created.majorVersion << "." << created.minorVersion << "!" << std::endl;
+			delete sfmlContext;
+			return false;
+		}
+
+		context = sfmlContext;
+
+		return true;
+#endif
+	}
+
+	void* HeadlessContext::getFunction(const char* name)
+	{
+#ifdef __linux__
+		// Core functions too, Mesa implements EGL_KHR_get_all_proc_addresses
+		return (void*)eglGetProcAddress(name);
+#else
+		return (void*)sf::Context::getFunction(name);
+#endif
+	}
+
+	void HeadlessContext::destroy()
+	{
+#ifdef __linux__
+		if (!display)
+			return;
+
+		eglMakeCurrent((EGLDisplay)display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+		if (surface)
+			eglDestroySurface((EGLDisplay)display, (EGLSurface)surface);
+
+		if (context)
+			eglDestroyContext((EGLDisplay)display, (EGLContext)context);
+
+		eglTerminate((EGLDisplay)display);
+#else
+		delete (sf::Context*)context;
+#endif
+
+		display = nullptr;
+		context = nullptr;
+		surface = nullptr;
+	}
+}
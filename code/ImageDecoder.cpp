@@ -0,0 +1,132 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "other/stb_image.h"
+#include "ImageDecoder.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MG_IMAGE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace mg
+{
+	static std::unordered_map<std::string, ImageDecodeFunction>& getDecoders()
+	{
+		static std::unordered_map<std::string, ImageDecodeFunction> decoders;
+		return decoders;
+	}
+
+	static bool decodeWithStb(const std::string& path, bool jpeg, int desiredChannels, DecodedImage& image)
+	{
+		// decodeImage flips with SIMD row swaps, stb_image copies through a small buffer
+		stbi_set_flip_vertically_on_load_thread(0);
+
+		// stb_image converts JPEG colours with SIMD only when writing 4 channels,
+		// RGBA decodes faster than RGB even though it uploads a third more
+		int fileChannels;
+
+		if (desiredChannels == 0 && jpeg && stbi_info(path.c_str(), &image.width, &image.height, &fileChannels) && fileChannels == 3)
+			desiredChannels = 4;
+
+		// Loading from the path lets stb_image read through its own buffer
+		// instead of a copy of the whole file
+		unsigned char* pixels = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, desiredChannels);
+
+		if (!pixels)
+			return false;
+
+		if (desiredChannels != 0)
+			image.channels = desiredChannels;
+
+		image.pixels = std::unique_ptr<unsigned char, void (*)(void*)>(pixels, stbi_image_free);
+
+		return true;
+	}
+
+	static bool readFile(const std::string& path, std::vector<unsigned char>& contents)
+	{
+		std::ifstream stream(path, std::ios::binary | std::ios::ate);
+
+		if (!stream)
+			return false;
+
+		contents.resize((size_t)stream.tellg());
+		stream.seekg(0);
+		stream.read((char*)contents.data(), contents.size());
+
+		return (bool)stream;
+	}
+
+	void setImageDecoder(const std::string& extension, ImageDecodeFunction decoder)
+	{
+		getDecoders()[extension] = std::move(decoder);
+	}
+
+	bool decodeImage(const std::string& path, DecodedImage& image, int desiredChannels, bool flipped)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+
+		auto it = getDecoders().find(extension);
+		bool decoded = false;
+
+		if (it != getDecoders().end())
+		{
+			std::vector<unsigned char> file;
+			decoded = readFile(path, file) && it->second(file.data(), file.size(), desiredChannels, image);
+		}
+		else
+		{
+			decoded = decodeWithStb(path, extension == ".jpg" || extension == ".jpeg", desiredChannels, image);
+		}
+
+		if (!decoded || !image.pixels)
+			return false;
+
+		if (flipped)
+			flipImageRows(image.pixels.get(), (size_t)image.width * image.channels, image.height);
+
+		return true;
+	}
+
+	void flipImageRows(unsigned char* pixels, size_t rowSize, int height)
+	{
+		for (int y = 0; y < height / 2; y++)
+		{
+			unsigned char* top = pixels + (size_t)y * rowSize;
+			unsigned char* bottom = pixels + (size_t)(height - 1 - y) * rowSize;
+
+			size_t x = 0;
+
+#ifdef MG_IMAGE_SSE2
+			// Swap both rows 32 bytes at a time, no row sized buffer in between
+			for (; x + 32 <= rowSize; x += 32)
+			{
+				__m128i top0 = _mm_loadu_si128((const __m128i*)(top + x));
+				__m128i top1 = _mm_loadu_si128((const __m128i*)(top + x + 16));
+				__m128i bottom0 = _mm_loadu_si128((const __m128i*)(bottom + x));
+				__m128i bottom1 = _mm_loadu_si128((const __m128i*)(bottom + x + 16));
+
+				_mm_storeu_si128((__m128i*)(top + x), bottom0);
+				_mm_storeu_si128((__m128i*)(top + x + 16), bottom1);
+				_mm_storeu_si128((__m128i*)(bottom + x), top0);
+				_mm_storeu_si128((__m128i*)(bottom + x + 16), top1);
+			}
+#endif
+
+			for (; x < rowSize; x++)
+				std::swap(top[x], bottom[x]);
+		}
+	}
+}
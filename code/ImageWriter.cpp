@@ -0,0 +1,138 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "ImageWriter.h"
+
+namespace mg
+{
+	struct CrcTable
+	{
+		uint32_t values[256];
+
+		CrcTable()
+		{
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t value = i;
+
+				for (int bit = 0; bit < 8; bit++)
+					value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+
+				values[i] = value;
+			}
+		}
+	};
+
+	static uint32_t crc32(const unsigned char* data, size_t length)
+	{
+		// Built on first use, thread safe as a local static
+		static const CrcTable table;
+
+		uint32_t crc = 0xFFFFFFFFu;
+
+		for (size_t i = 0; i < length; i++)
+			crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+		return ~crc;
+	}
+
+	// PNG integers are big endian
+	static void writeBigEndian(std::vector<unsigned char>& output, uint32_t value)
+	{
+		output.push_back((unsigned char)(value >> 24));
+		output.push_back((unsigned char)(value >> 16));
+		output.push_back((unsigned char)(value >> 8));
+		output.push_back((unsigned char)value);
+	}
+
+	static void writeChunk(std::vector<unsigned char>& output, const char* type, const std::vector<unsigned char>& data)
+	{
+		writeBigEndian(output, (uint32_t)data.size());
+
+		size_t typeOffset = output.size();
+		output.insert(output.end(), type, type + 4);
+		output.insert(output.end(), data.begin(), data.end());
+
+		writeBigEndian(output, crc32(output.data() + typeOffset, data.size() + 4));
+	}
+
+	bool writePNG(const std::string& path, const unsigned char* pixels, int width, int height, bool flipped)
+	{
+		std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+		std::vector<unsigned char> header;
+		writeBigEndian(header, width);
+		writeBigEndian(header, height);
+
+		// 8 bits, RGBA, deflate, adaptive filters, no interlace
+		header.insert(header.end(), { 8, 6, 0, 0, 0 });
+		writeChunk(png, "IHDR", header);
+
+		// Rows with filter type 0 in front
+		size_t rowSize = (size_t)width * 4;
+		std::vector<unsigned char> scanlines;
+		scanlines.reserve((rowSize + 1) * height);
+
+		for (int y = 0; y < height; y++)
+		{
+			const unsigned char* row = pixels + (flipped ? height - 1 - y : y) * rowSize;
+
+			scanlines.push_back(0);
+			scanlines.insert(scanlines.end(), row, row + rowSize);
+		}
+
+		// zlib stream of stored deflate blocks, at most 65535 bytes each
+		std::vector<unsigned char> zlib = { 0x78, 0x01 };
+
+		size_t offset = 0;
+
+		do
+		{
+			size_t blockSize = scanlines.size() - offset < 65535 ? scanlines.size() - offset : 65535;
+			bool last = offset + blockSize == scanlines.size();
+
+			zlib.push_back(last ? 1 : 0);
+			zlib.push_back((unsigned char)blockSize);
+			zlib.push_back((unsigned char)(blockSize >> 8));
+			zlib.push_back((unsigned char)~blockSize);
+			zlib.push_back((unsigned char)(~blockSize >> 8));
+
+			zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+			offset += blockSize;
+		}
+		while (offset < scanlines.size());
+
+		// Adler-32 of the uncompressed data
+		uint32_t a = 1, b = 0;
+
+		for (unsigned char value : scanlines)
+		{
+			a = (a + value) % 65521;
+			b = (b + a) % 65521;
+		}
+
+		writeBigEndian(zlib, (b << 16) | a);
+
+		writeChunk(png, "IDAT", zlib);
+		writeChunk(png, "IEND", {});
+
+		std::ofstream stream(path, std::ios::binary);
+		stream.write((const char*)png.data(), png.size());
+
+		if (!stream)
+		{
+			std::cout << "Failed to write " << path << "!" << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+}
@@ -3,8 +3,12 @@
 // @miguelgutierrezruano
 // 2023
 
+#include <cassert>
+
 #include "IndexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
 
 namespace mg
 {
@@ -12,22 +16,36 @@ namespace mg
 		count(bufferCount)
 	{
 		glGenBuffers(1, &id);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+		GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW);
+
+		if (data)
+			RenderStats::countBufferUpload(count * sizeof(unsigned int));
 	}
 
 	IndexBuffer::~IndexBuffer()
 	{
-		glDeleteBuffers(1, &id);
+		GLStateCache::deleteBuffer(id);
 	}
 
 	void IndexBuffer::bind()
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+		GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
 	}
 
 	void IndexBuffer::unbind()
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		GLStateCache::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	void IndexBuffer::setData(const unsigned int* data, unsigned int dataCount, unsigned int offset)
+	{
+		assert(offset + dataCount <= count);
+
+		// Element binding is vertex array state, upload through a target that is not
+		GLStateCache::bindBuffer(GL_COPY_WRITE_BUFFER, id);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, offset * sizeof(unsigned int), dataCount * sizeof(unsigned int), data);
+
+		RenderStats::countBufferUpload(dataCount * sizeof(unsigned int));
 	}
 }
\ No newline at end of file
@@ -0,0 +1,41 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <iostream>
+
+#include "MeshPool.h"
+
+namespace mg
+{
+	MeshPool::MeshPool(const VertexBufferLayout& layout, unsigned int maxVertexCount, unsigned int maxIndexCount)
+		: vertexBuffer((size_t)maxVertexCount * layout.getStride()), vertexStride(layout.getStride()),
+		  maxVertices(maxVertexCount), maxIndices(maxIndexCount), vertexCount(0), indexCount(0)
+	{
+		vertexArray.addBuffer(vertexBuffer, layout);
+
+		// Created while the vertex array is bound so it becomes part of its state
+		indexBuffer = std::make_unique<IndexBuffer>(nullptr, maxIndices);
+		vertexArray.unbind();
+	}
+
+	MeshRange MeshPool::addMesh(const void* vertices, unsigned int meshVertexCount, const unsigned int* indices, unsigned int meshIndexCount)
+	{
+		if (vertexCount + meshVertexCount > maxVertices || indexCount + meshIndexCount > maxIndices)
+		{
+			std::cout << "Warning: Mesh pool is full!" << std::endl;
+			return { 0, 0, 0 };
+		}
+
+		vertexBuffer.setData(vertices, (size_t)meshVertexCount * vertexStride, (size_t)vertexCount * vertexStride);
+		indexBuffer->setData(indices, meshIndexCount, indexCount);
+
+		MeshRange range = { indexCount, meshIndexCount, (int)vertexCount };
+
+		vertexCount += meshVertexCount;
+		indexCount += meshIndexCount;
+
+		return range;
+	}
+}
@@ -0,0 +1,142 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include "Mipmap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MG_MIPMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace mg
+{
+	unsigned int getMipLevelCount(int width, int height)
+	{
+		unsigned int levels = 1;
+		int size = width > height ? width : height;
+
+		while (size > 1)
+		{
+			size >>= 1;
+			levels++;
+		}
+
+		return levels;
+	}
+
+	void downsampleRGBA8(const unsigned char* source, int width, int height, unsigned char* destination)
+	{
+		int mipWidth = getMipSize(width, 1);
+		int mipHeight = getMipSize(height, 1);
+
+		size_t sourcePitch = (size_t)width * 4;
+
+		for (int y = 0; y < mipHeight; y++)
+		{
+			// Height of 1 reads the same row twice
+			const unsigned char* row0 = source + 2 * y * sourcePitch;
+			const unsigned char* row1 = 2 * y + 1 < height ? row0 + sourcePitch : row0;
+
+			unsigned char* output = destination + (size_t)y * mipWidth * 4;
+			int x = 0;
+
+#ifdef MG_MIPMAP_SSE2
+			// Two output texels from four input texels of each row
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i rounding = _mm_set1_epi16(2);
+
+			for (; 2 * x + 3 < width && x + 1 < mipWidth; x += 2)
+			{
+				__m128i top    = _mm_loadu_si128((const __m128i*)(row0 + x * 8));
+				__m128i bottom = _mm_loadu_si128((const __m128i*)(row1 + x * 8));
+
+				// Vertical sums in 16 bits, texels 0 1 in low, 2 3 in high
+				__m128i low  = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+				__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+				// Horizontal sums, texel 0 + 1 and texel 2 + 3
+				__m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+				sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+
+				_mm_storel_epi64((__m128i*)(output + x * 4), _mm_packus_epi16(sum, sum));
+			}
+#endif
+
+			for (; x < mipWidth; x++)
+			{
+				// Width of 1 reads the same column twice
+				int x0 = 2 * x;
+				int x1 = x0 + 1 < width ? x0 + 1 : x0;
+
+				for (int channel = 0; channel < 4; channel++)
+				{
+					unsigned int sum = row0[x0 * 4 + channel] + row0[x1 * 4 + channel] +
+					                   row1[x0 * 4 + channel] + row1[x1 * 4 + channel];
+
+					output[x * 4 + channel] = (unsigned char)((sum + 2) >> 2);
+				}
+			}
+		}
+	}
+
+	void downsampleImage(const unsigned char* source, int width, int height, int channels, unsigned char* destination)
+	{
+		if (channels == 4)
+		{
+			downsampleRGBA8(source, width, height, destination);
+			return;
+		}
+
+		int mipWidth = getMipSize(width, 1);
+		int mipHeight = getMipSize(height, 1);
+
+		size_t sourcePitch = (size_t)width * channels;
+
+		for (int y = 0; y < mipHeight; y++)
+		{
+			const unsigned char* row0 = source + 2 * y * sourcePitch;
+			const unsigned char* row1 = 2 * y + 1 < height ? row0 + sourcePitch : row0;
+
+			unsigned char* output = destination + (size_t)y * mipWidth * channels;
+
+			for (int x = 0; x < mipWidth; x++)
+			{
+				int x0 = 2 * x;
+				int x1 = x0 + 1 < width ? x0 + 1 : x0;
+
+				for (int channel = 0; channel < channels; channel++)
+				{
+					unsigned int sum = row0[x0 * channels + channel] + row0[x1 * channels + channel] +
+					                   row1[x0 * channels + channel] + row1[x1 * channels + channel];
+
+					output[x * channels + channel] = (unsigned char)((sum + 2) >> 2);
+				}
+			}
+		}
+	}
+
+	std::vector<unsigned char> buildMipChain(const unsigned char* pixels, int width, int height, unsigned int levelCount, int channels)
+	{
+		size_t totalSize = 0;
+
+		for (unsigned int level = 1; level < levelCount; level++)
+			totalSize += getMipByteSize(width, height, level, channels);
+
+		std::vector<unsigned char> chain(totalSize);
+
+		const unsigned char* source = pixels;
+		unsigned char* destination = chain.data();
+
+		for (unsigned int level = 1; level < levelCount; level++)
+		{
+			downsampleImage(source, getMipSize(width, level - 1), getMipSize(height, level - 1), channels, destination);
+
+			source = destination;
+			destination += getMipByteSize(width, height, level, channels);
+		}
+
+		return chain;
+	}
+}
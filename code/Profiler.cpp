@@ -0,0 +1,326 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Profiler.h"
+
+using namespace std::chrono;
+
+namespace mg
+{
+	// Zones a thread can record between two frame marks
+	static const size_t RING_CAPACITY = 1 << 14;
+
+	// Ring of zones of one thread, or of a timeline like the GPU
+	struct ProfileTrack
+	{
+		ProfileZone zones[RING_CAPACITY];
+
+		// Written by one thread only, zones before it are complete
+		std::atomic<uint64_t> written { 0 };
+
+		// Under the registry mutex from here on
+		uint64_t read = 0;
+
+		unsigned int trackId = 0;
+		std::string name;
+
+		// Not bound to a thread, created with Profiler::createTrack
+		bool timeline = false;
+	};
+
+	namespace
+	{
+		struct CapturedZone
+		{
+			ProfileZone zone;
+			unsigned int trackId;
+		};
+
+		struct Registry
+		{
+			std::mutex mutex;
+			std::vector<std::unique_ptr<ProfileTrack>> tracks;
+
+			// Capture state, frameMark runs on the main thread only
+			unsigned int requestedFrames = 0;
+			unsigned int capturedFrames = 0;
+			std::string path;
+
+			uint64_t frameStart = 0;
+			uint64_t captureStart = 0;
+			uint64_t droppedZones = 0;
+
+			std::vector<CapturedZone> zones;
+		};
+
+		const steady_clock::time_point epoch = steady_clock::now();
+
+		// Never destroyed, worker threads may still record while statics go away
+		Registry& getRegistry()
+		{
+			static Registry* registry = new Registry();
+			return *registry;
+		}
+
+		// Kept by the registry after the thread exits, until its zones are drained
+		thread_local ProfileTrack* threadTrack = nullptr;
+
+		// Threads get a buffer on their first zone, named threads that never
+		// record do not take the memory
+		thread_local std::string threadName;
+
+		ProfileTrack& getThreadTrack()
+		{
+			if (!threadTrack)
+			{
+				Registry& registry = getRegistry();
+				std::lock_guard<std::mutex> lock(registry.mutex);
+
+				registry.tracks.push_back(std::make_unique<ProfileTrack>());
+				threadTrack = registry.tracks.back().get();
+				threadTrack->trackId = (unsigned int)registry.tracks.size();
+				threadTrack->name = threadName.empty() ? "Thread " + std::to_string(threadTrack->trackId) : threadName;
+			}
+
+			return *threadTrack;
+		}
+
+		// Move complete zones of every track to the capture, mutex has to be held
+		void drainTracks(Registry& registry, bool keep)
+		{
+			for (const std::unique_ptr<ProfileTrack>& track : registry.tracks)
+			{
+				uint64_t written = track->written.load(std::memory_order_acquire);
+
+				// The writer went around the ring since the last drain
+				if (written - track->read > RING_CAPACITY)
+				{
+					registry.droppedZones += written - track->read - RING_CAPACITY;
+					track->read = written - RING_CAPACITY;
+				}
+
+				if (keep)
+				{
+					size_t first = registry.zones.size();
+
+					for (uint64_t i = track->read; i < written; i++)
+						registry.zones.push_back({ track->zones[i & (RING_CAPACITY - 1)], track->trackId });
+
+					// Slots overwritten while they were copied are not trusted
+					uint64_t after = track->written.load(std::memory_order_acquire);
+
+					if (after - track->read > RING_CAPACITY)
+					{
+						size_t count = (size_t)(std::min(after - RING_CAPACITY, written) - track->read);
+						registry.zones.erase(registry.zones.begin() + first, registry.zones.begin() + first + count);
+						registry.droppedZones += count;
+					}
+				}
+
+				track->read = written;
+			}
+		}
+
+		void writeEscaped(std::ostream& stream, const std::string& text)
+		{
+			for (char c : text)
+			{
+				if (c == '"' || c == '\\')
+					stream << '\\';
+
+				stream << c;
+			}
+		}
+
+		bool writeChromeTrace(const Registry& registry)
+		{
+			std::filesystem::path path = registry.path;
+
+			if (path.has_parent_path())
+				std::filesystem::create_directories(path.parent_path());
+
+			std::ofstream stream(path);
+
+			if (!stream)
+			{
+				std::cout << "Could not write profile capture to " << registry.path << "!" << std::endl;
+				return false;
+			}
+
+			stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+			bool first = true;
+
+			for (const std::unique_ptr<ProfileTrack>& track : registry.tracks)
+			{
+				stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track->trackId
+					<< ",\"args\":{\"name\":\"";
+				writeEscaped(stream, track->name);
+				stream << "\"}}";
+
+				first = false;
+			}
+
+			// Microseconds with nanoseconds in the fraction
+			stream.setf(std::ios::fixed);
+			stream.precision(3);
+
+			for (const CapturedZone& captured : registry.zones)
+			{
+				const ProfileZone& zone = captured.zone;
+
+				// Zones read back late, like GPU ones, may be older than the capture
+				if (zone.end < registry.captureStart)
+					continue;
+
+				// Zones started before the capture are cut at its start
+				uint64_t start = zone.start < registry.captureStart ? registry.captureStart : zone.start;
+
+				stream << ",\n{\"name\":\"";
+				writeEscaped(stream, zone.name);
+				stream << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << captured.trackId
+					<< ",\"ts\":" << (start - registry.captureStart) / 1000.0
+					<< ",\"dur\":" << (zone.end - start) / 1000.0 << "}";
+			}
+
+			stream << "\n]}\n";
+
+			return (bool)stream;
+		}
+	}
+
+	std::atomic<bool> Profiler::recording(false);
+
+	uint64_t Profiler::now()
+	{
+		return (uint64_t)duration_cast<nanoseconds>(steady_clock::now() - epoch).count();
+	}
+
+	void Profiler::record(const char* name, uint64_t start, uint64_t end)
+	{
+		record(getThreadTrack(), name, start, end);
+	}
+
+	void Profiler::record(ProfileTrack& track, const char* name, uint64_t start, uint64_t end)
+	{
+		// Single writer, the slot is published by the release store
+		uint64_t index = track.written.load(std::memory_order_relaxed);
+		track.zones[index & (RING_CAPACITY - 1)] = { name, start, end };
+		track.written.store(index + 1, std::memory_order_release);
+	}
+
+	ProfileTrack& Profiler::createTrack(const std::string& name)
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		// Reused, recreating the owner of a track does not take more memory
+		for (const std::unique_ptr<ProfileTrack>& track : registry.tracks)
+		{
+			if (track->timeline && track->name == name)
+				return *track;
+		}
+
+		registry.tracks.push_back(std::make_unique<ProfileTrack>());
+
+		ProfileTrack& track = *registry.tracks.back();
+		track.trackId = (unsigned int)registry.tracks.size();
+		track.name = name;
+		track.timeline = true;
+
+		return track;
+	}
+
+	void Profiler::setThreadName(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(getRegistry().mutex);
+
+		threadName = name;
+
+		if (threadTrack)
+			threadTrack->name = name;
+	}
+
+	void Profiler::frameMark()
+	{
+		// Registers the main thread before the registry mutex is taken
+		ProfileTrack& mainThread = getThreadTrack();
+
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		uint64_t frameEnd = now();
+
+		if (isRecording())
+		{
+			drainTracks(registry, true);
+
+			registry.zones.push_back({ { "Frame", registry.frameStart, frameEnd }, mainThread.trackId });
+			registry.capturedFrames++;
+
+			if (registry.capturedFrames == registry.requestedFrames)
+			{
+				recording.store(false, std::memory_order_relaxed);
+
+				if (writeChromeTrace(registry))
+				{
+					std::cout << "Captured " << registry.capturedFrames << " frames, " << registry.zones.size() << " zones to "
+						<< registry.path << std::endl;
+				}
+
+				if (registry.droppedZones > 0)
+					std::cout << "Warning: " << registry.droppedZones << " zones were lost, ring buffers were full!" << std::endl;
+
+				registry.zones.clear();
+				registry.zones.shrink_to_fit();
+				registry.requestedFrames = 0;
+			}
+		}
+		else if (registry.requestedFrames > 0)
+		{
+			// Start at a frame boundary, zones left from earlier captures are dropped
+			drainTracks(registry, false);
+
+			registry.capturedFrames = 0;
+			registry.droppedZones = 0;
+			registry.captureStart = frameEnd;
+
+			recording.store(true, std::memory_order_relaxed);
+		}
+
+		registry.frameStart = frameEnd;
+	}
+
+	bool Profiler::captureFrames(unsigned int frameCount, const std::string& path)
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		if (frameCount == 0 || registry.requestedFrames > 0)
+			return false;
+
+		registry.requestedFrames = frameCount;
+		registry.path = path;
+
+		return true;
+	}
+
+	bool Profiler::isCapturing()
+	{
+		Registry& registry = getRegistry();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+
+		return registry.requestedFrames > 0;
+	}
+}
@@ -0,0 +1,114 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include "RenderQueue.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "RenderStats.h"
+
+namespace mg
+{
+	void RenderQueue::submit(const DrawCommand& command, float depth)
+	{
+		entries.push_back({ makeKey(command, depth), (uint32_t)commands.size() });
+		commands.push_back(command);
+	}
+
+	void RenderQueue::flush()
+	{
+		if (commands.empty())
+			return;
+
+		sort();
+
+		Shader*      currentShader      = nullptr;
+		Texture*     currentTexture     = nullptr;
+		VertexArray* currentVertexArray = nullptr;
+		IndexBuffer* currentIndexBuffer = nullptr;
+
+		for (const SortEntry& entry : entries)
+		{
+			const DrawCommand& command = commands[entry.command];
+
+			if (command.shader != currentShader)
+			{
+				command.shader->bind();
+				currentShader = command.shader;
+			}
+
+			if (command.texture && command.texture != currentTexture)
+			{
+				command.texture->bind();
+				currentTexture = command.texture;
+			}
+
+			// Element buffer binding is part of the vertex array state
+			if (command.vertexArray != currentVertexArray)
+			{
+				command.vertexArray->bind();
+				currentVertexArray = command.vertexArray;
+				currentIndexBuffer = nullptr;
+			}
+
+			if (command.indexBuffer != currentIndexBuffer)
+			{
+				command.indexBuffer->bind();
+				currentIndexBuffer = command.indexBuffer;
+			}
+
+			if (command.instanceCount == 1)
+				glDrawElements(GL_TRIANGLES, command.indexBuffer->GetCount(), GL_UNSIGNED_INT, nullptr);
+			else
+				glDrawElementsInstanced(GL_TRIANGLES, command.indexBuffer->GetCount(), GL_UNSIGNED_INT, nullptr, command.instanceCount);
+
+			RenderStats::countDraw(command.indexBuffer->GetCount(), command.instanceCount);
+		}
+
+		commands.clear();
+		entries.clear();
+	}
+
+	uint64_t RenderQueue::makeKey(const DrawCommand& command, float depth)
+	{
+		// Only the low bits of each object name are used, a collision
+		// just splits a group, state changes are still compared exactly
+		uint64_t shader      = command.shader      ? command.shader->getId()      & 0xFFFF : 0;
+		uint64_t texture     = command.texture     ? command.texture->getId()     & 0xFFFF : 0;
+		uint64_t vertexArray = command.vertexArray ? command.vertexArray->getId() & 0xFFFF : 0;
+
+		// Quantize depth in [0, 1] to 16 bits
+		if (depth < 0.0f) depth = 0.0f;
+		if (depth > 1.0f) depth = 1.0f;
+		uint64_t quantizedDepth = (uint64_t)(depth * 65535.0f);
+
+		return (shader << 48) | (texture << 32) | (vertexArray << 16) | quantizedDepth;
+	}
+
+	void RenderQueue::sort()
+	{
+		// LSD radix sort, 8 bits per pass, stable so equal keys keep submission order
+		scratch.resize(entries.size());
+
+		for (unsigned int shift = 0; shift < 64; shift += 8)
+		{
+			size_t histogram[257] = { 0 };
+
+			for (const SortEntry& entry : entries)
+				histogram[((entry.key >> shift) & 0xFF) + 1]++;
+
+			// Skip pass if every key shares this digit
+			if (histogram[((entries[0].key >> shift) & 0xFF) + 1] == entries.size())
+				continue;
+
+			for (unsigned int i = 1; i < 257; i++)
+				histogram[i] += histogram[i - 1];
+
+			for (const SortEntry& entry : entries)
+				scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+
+			entries.swap(scratch);
+		}
+	}
+}
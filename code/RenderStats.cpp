@@ -0,0 +1,114 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+
+#include "RenderStats.h"
+
+namespace mg
+{
+	FrameStats RenderStats::current = {};
+
+	std::vector<FrameStats> RenderStats::history(300);
+	size_t RenderStats::next = 0;
+	size_t RenderStats::frameCount = 0;
+
+	GLStateCounters RenderStats::stateAtFrameStart = {};
+
+	uint64_t FrameStats::get(RenderStat stat) const
+	{
+		switch (stat)
+		{
+			case RenderStat::DRAW_CALLS:	  return drawCalls;
+			case RenderStat::TRIANGLES:		  return triangles;
+			case RenderStat::STATE_CHANGES:	  return stateChanges.totalIssued();
+			case RenderStat::UNIFORM_UPLOADS: return uniformUploads;
+			case RenderStat::BUFFER_BYTES:	  return bufferBytes;
+			case RenderStat::TEXTURE_BINDS:	  return stateChanges.issued[(int)GLStateKind::TEXTURE];
+			case RenderStat::SHADER_SWITCHES: return stateChanges.issued[(int)GLStateKind::PROGRAM];
+			default:						  return 0;
+		}
+	}
+
+	void RenderStats::endFrame()
+	{
+		const GLStateCounters& state = GLStateCache::getCounters();
+
+		// A reset of the cache counters during the frame counts from zero
+		for (int kind = 0; kind < (int)GLStateKind::COUNT; kind++)
+		{
+			uint64_t issuedStart = std::min(stateAtFrameStart.issued[kind], state.issued[kind]);
+			uint64_t skippedStart = std::min(stateAtFrameStart.skipped[kind], state.skipped[kind]);
+
+			current.stateChanges.issued[kind] = state.issued[kind] - issuedStart;
+			current.stateChanges.skipped[kind] = state.skipped[kind] - skippedStart;
+		}
+
+		stateAtFrameStart = state;
+
+		history[next] = current;
+		next = (next + 1) % history.size();
+		frameCount = std::min(frameCount + 1, history.size());
+
+		current = {};
+	}
+
+	const FrameStats& RenderStats::getLastFrame()
+	{
+		static const FrameStats empty = {};
+
+		if (frameCount == 0)
+			return empty;
+
+		return history[(next + history.size() - 1) % history.size()];
+	}
+
+	void RenderStats::setHistorySize(size_t frames)
+	{
+		history.assign(std::max<size_t>(frames, 1), FrameStats());
+		next = 0;
+		frameCount = 0;
+	}
+
+	StatSummary RenderStats::summarize(RenderStat stat)
+	{
+		if (frameCount == 0)
+			return { 0, 0.0, 0, 0 };
+
+		// Oldest frames are overwritten first, order does not matter here
+		std::vector<uint64_t> values(frameCount);
+		uint64_t total = 0;
+
+		for (size_t i = 0; i < frameCount; i++)
+		{
+			values[i] = history[i].get(stat);
+			total += values[i];
+		}
+
+		// Nearest rank, the value 99% of the frames do not go over
+		size_t rank = (frameCount * 99 + 99) / 100 - 1;
+		std::nth_element(values.begin(), values.begin() + rank, values.end());
+		uint64_t p99 = values[rank];
+
+		auto range = std::minmax_element(values.begin(), values.end());
+
+		return { *range.first, (double)total / frameCount, p99, *range.second };
+	}
+
+	const char* RenderStats::getName(RenderStat stat)
+	{
+		switch (stat)
+		{
+			case RenderStat::DRAW_CALLS:	  return "Draw calls";
+			case RenderStat::TRIANGLES:		  return "Triangles";
+			case RenderStat::STATE_CHANGES:	  return "State changes";
+			case RenderStat::UNIFORM_UPLOADS: return "Uniform uploads";
+			case RenderStat::BUFFER_BYTES:	  return "Buffer bytes";
+			case RenderStat::TEXTURE_BINDS:	  return "Texture binds";
+			case RenderStat::SHADER_SWITCHES: return "Shader switches";
+			default:						  return "Unknown";
+		}
+	}
+}
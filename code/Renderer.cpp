@@ -4,6 +4,12 @@
 // 2023
 
 #include "Renderer.h"
+#include "Texture.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
 
 namespace mg
 {
@@ -23,17 +29,158 @@ namespace mg
         return true;
     }
 
+    Renderer::Renderer()
+        : submitMode(SubmitMode::IMMEDIATE), indirectBuffer(0), indirectBufferSize(0)
+    {
+    }
+
+    Renderer::~Renderer()
+    {
+        if (indirectBuffer)
+            GLStateCache::deleteBuffer(indirectBuffer);
+    }
+
+    void Renderer::setSubmitMode(SubmitMode mode)
+    {
+        // Do not lose draws recorded with the previous mode
+        if (submitMode == SubmitMode::DEFERRED)
+            flush();
+
+        submitMode = mode;
+    }
+
     void Renderer::clear()
     {
+        GPUProfileScope gpuProfile("Renderer::clear");
+
         glClear(GL_COLOR_BUFFER_BIT);
     }
 
     void Renderer::draw(VertexArray& vertexArray, IndexBuffer& indexBuffer, Shader& shader)
     {
+        ProfileScope profile("Renderer::draw");
+        GPUProfileScope gpuProfile("Renderer::draw");
+
+        // Skip shaders still compiling instead of stalling the frame
+        if (!shader.ready())
+            return;
+
+        if (submitMode == SubmitMode::DEFERRED)
+        {
+            queue.submit({ &vertexArray, &indexBuffer, &shader, nullptr, 1 }, 0.0f);
+            return;
+        }
+
         shader.bind();
         vertexArray.bind();
         indexBuffer.bind();
 
         glDrawElements(GL_TRIANGLES, indexBuffer.GetCount(), GL_UNSIGNED_INT, nullptr);
+
+        RenderStats::countDraw(indexBuffer.GetCount());
+    }
+
+    void Renderer::draw(VertexArray& vertexArray, IndexBuffer& indexBuffer, Shader& shader, Texture& texture, float depth)
+    {
+        ProfileScope profile("Renderer::draw");
+
+        if (!shader.ready())
+            return;
+
+        if (submitMode == SubmitMode::DEFERRED)
+        {
+            queue.submit({ &vertexArray, &indexBuffer, &shader, &texture, 1 }, depth);
+            return;
+        }
+
+        texture.bind();
+        draw(vertexArray, indexBuffer, shader);
+    }
+
+    void Renderer::drawInstanced(VertexArray& vertexArray, IndexBuffer& indexBuffer, Shader& shader, unsigned int instanceCount)
+    {
+        ProfileScope profile("Renderer::drawInstanced");
+        GPUProfileScope gpuProfile("Renderer::drawInstanced");
+
+        if (instanceCount == 0 || !shader.ready())
+            return;
+
+        if (submitMode == SubmitMode::DEFERRED)
+        {
+            queue.submit({ &vertexArray, &indexBuffer, &shader, nullptr, instanceCount }, 0.0f);
+            return;
+        }
+
+        shader.bind();
+        vertexArray.bind();
+        indexBuffer.bind();
+
+        glDrawElementsInstanced(GL_TRIANGLES, indexBuffer.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount);
+
+        RenderStats::countDraw(indexBuffer.GetCount(), instanceCount);
+    }
+
+    void Renderer::drawIndirect(MeshPool& pool, Shader& shader, const std::vector<DrawElementsIndirectCommand>& commands)
+    {
+        ProfileScope profile("Renderer::drawIndirect");
+        GPUProfileScope gpuProfile("Renderer::drawIndirect");
+
+        if (commands.empty() || !shader.ready())
+            return;
+
+        shader.bind();
+        pool.getVertexArray().bind();
+        pool.getIndexBuffer().bind();
+
+        if (GLExtensions::hasMultiDrawIndirect)
+        {
+            size_t size = commands.size() * sizeof(DrawElementsIndirectCommand);
+
+            if (!indirectBuffer)
+                glGenBuffers(1, &indirectBuffer);
+
+            GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+
+            // Orphan every frame so the upload does not wait for the previous draw
+            if (size > indirectBufferSize)
+                indirectBufferSize = size;
+
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, indirectBufferSize, nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, commands.data());
+
+            GLExtensions::multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)commands.size(), 0);
+
+            // One call for the driver, every command for the triangle count
+            uint64_t triangles = 0;
+
+            for (const DrawElementsIndirectCommand& command : commands)
+                triangles += (uint64_t)command.count / 3 * command.instanceCount;
+
+            RenderStats::countDraws(1, triangles);
+            RenderStats::countBufferUpload(size);
+            return;
+        }
+
+        for (const DrawElementsIndirectCommand& command : commands)
+        {
+            const void* indices = (const void*)(command.firstIndex * sizeof(unsigned int));
+
+            if (command.instanceCount == 1)
+                glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, indices, command.baseVertex);
+            else if (command.instanceCount > 1)
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, indices, command.instanceCount, command.baseVertex);
+            else
+                continue;
+
+            RenderStats::countDraw(command.count, command.instanceCount);
+        }
+    }
+
+    void Renderer::flush()
+    {
+        ProfileScope profile("Renderer::flush");
+        GPUProfileScope gpuProfile("Renderer::flush");
+
+        queue.flush();
     }
 }
@@ -5,152 +5,614 @@
 
 #include <glad/glad.h>
 
+#include <cstring>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
+#include <vector>
 
 #include "Renderer.h"
 #include "Shader.h"
+#include "GLStateCache.h"
+#include "UniformBuffer.h"
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+#include "ShaderPreprocessor.h"
+#include "Profiler.h"
+#include "RenderStats.h"
 
 namespace mg
 {
-	Shader::Shader(const std::string& shaderPath)
-		: path(shaderPath), id(0)
+    // Every sampler type of OpenGL 3.3, set with the texture unit they read
+    static bool isSamplerType(unsigned int type)
+    {
+        switch (type)
+        {
+            case GL_SAMPLER_1D:
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_3D:
+            case GL_SAMPLER_CUBE:
+            case GL_SAMPLER_1D_SHADOW:
+            case GL_SAMPLER_2D_SHADOW:
+            case GL_SAMPLER_1D_ARRAY:
+            case GL_SAMPLER_2D_ARRAY:
+            case GL_SAMPLER_1D_ARRAY_SHADOW:
+            case GL_SAMPLER_2D_ARRAY_SHADOW:
+            case GL_SAMPLER_CUBE_SHADOW:
+            case GL_SAMPLER_2D_MULTISAMPLE:
+            case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_SAMPLER_2D_RECT:
+            case GL_SAMPLER_2D_RECT_SHADOW:
+            case GL_SAMPLER_BUFFER:
+            case GL_INT_SAMPLER_1D:
+            case GL_INT_SAMPLER_2D:
+            case GL_INT_SAMPLER_3D:
+            case GL_INT_SAMPLER_CUBE:
+            case GL_INT_SAMPLER_1D_ARRAY:
+            case GL_INT_SAMPLER_2D_ARRAY:
+            case GL_INT_SAMPLER_2D_MULTISAMPLE:
+            case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_INT_SAMPLER_2D_RECT:
+            case GL_INT_SAMPLER_BUFFER:
+            case GL_UNSIGNED_INT_SAMPLER_1D:
+            case GL_UNSIGNED_INT_SAMPLER_2D:
+            case GL_UNSIGNED_INT_SAMPLER_3D:
+            case GL_UNSIGNED_INT_SAMPLER_CUBE:
+            case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+            case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+            case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            case GL_UNSIGNED_INT_SAMPLER_BUFFER:   return true;
+        }
+
+        return false;
+    }
+
+    ShaderCache* Shader::programCache = nullptr;
+
+	Shader::Shader(const std::string& shaderPath, ShaderCompileMode mode)
+		: path(shaderPath), id(0), state(ShaderState::COMPILING), pendingId(0), pendingChecked(false), vertexShader(0), fragmentShader(0),
+		  storeInCache(false), cacheKey(0)
+	{
+        ProfileScope profile("Shader::load");
+
+        // Expand includes, stages are handed to the driver as slices of this text
+        std::string text = getPreprocessor().process(shaderPath);
+
+        create(splitShaderSource(text), mode);
+	}
+
+	Shader::Shader(const ShaderSource& source, const std::string& name, ShaderCompileMode mode)
+		: path(name), id(0), state(ShaderState::COMPILING), pendingId(0), pendingChecked(false), vertexShader(0), fragmentShader(0),
+		  storeInCache(false), cacheKey(0)
 	{
-        // Parse shader code
-        ShaderSource source = parseShader(shaderPath);
-        id = createShader(source.vertexSource, source.fragmentSource);
+        create(source.view(), mode);
 	}
 
 	Shader::~Shader()
 	{
-        glDeleteProgram(id);
+        if (vertexShader)
+            glDeleteShader(vertexShader);
+
+        if (fragmentShader)
+            glDeleteShader(fragmentShader);
+
+        if (pendingId)
+            glDeleteProgram(pendingId);
+
+        GLStateCache::deleteProgram(id);
 	}
 
 	void Shader::bind() const
 	{
-        glUseProgram(id);
+        GLStateCache::useProgram(id);
 	}
 
 	void Shader::unbind() const
 	{
-        glUseProgram(0);
+        GLStateCache::useProgram(0);
 	}
 
-	void Shader::setUniform4f(const std::string& name, glm::vec4 vec)
+    bool Shader::ready()
+    {
+        if (state == ShaderState::COMPILING)
+        {
+            // Driver still working in the background
+            if (!linkCompleted(id))
+                return false;
+
+            state = finishProgram(id) ? ShaderState::READY : ShaderState::FAILED;
+
+            if (state == ShaderState::READY)
+                reflectProgram();
+        }
+
+        return state == ShaderState::READY;
+    }
+
+    void Shader::reload(const std::string& text)
+    {
+        ProfileScope profile("Shader::reload");
+
+        // Stages are shared with the first build, let it finish
+        if (state == ShaderState::COMPILING)
+        {
+            state = finishProgram(id) ? ShaderState::READY : ShaderState::FAILED;
+
+            if (state == ShaderState::READY)
+                reflectProgram();
+        }
+
+        // Newer source replaces a reload still compiling
+        if (pendingId)
+        {
+            glDeleteShader(vertexShader);
+            glDeleteShader(fragmentShader);
+            glDeleteProgram(pendingId);
+
+            vertexShader = 0;
+            fragmentShader = 0;
+            pendingId = 0;
+        }
+
+        ShaderSourceView source = splitShaderSource(text);
+
+        if (source.vertexSource.empty() || source.fragmentSource.empty())
+        {
+            std::cout << "Reload of " << path << " has no vertex or fragment stage, keeping previous program" << std::endl;
+            return;
+        }
+
+        bool cached;
+        pendingId = loadProgram(source, cached);
+        pendingChecked = false;
+
+        if (cached)
+            swapProgram();
+    }
+
+    bool Shader::updateReload()
+    {
+        if (!pendingId)
+            return false;
+
+        // Without parallel compile the query below waits for the driver,
+        // give it a frame to make progress first
+        if (!GLExtensions::hasParallelShaderCompile && !pendingChecked)
+        {
+            pendingChecked = true;
+            return true;
+        }
+
+        if (!linkCompleted(pendingId))
+            return true;
+
+        if (finishProgram(pendingId))
+        {
+            swapProgram();
+            return false;
+        }
+
+        std::cout << "Keeping previous program of " << path << std::endl;
+
+        glDeleteProgram(pendingId);
+        pendingId = 0;
+
+        return false;
+    }
+
+    UniformHandle Shader::uniform(UniformName name)
+    {
+        return UniformHandle(getUniformSlot(name));
+    }
+
+	void Shader::setUniform4f(UniformName name, glm::vec4 vec)
 	{
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
+
         glUniform4f(getUniformLocation(name), vec.x, vec.y, vec.z, vec.w);
 	}
 
-    void Shader::setUniform1i(const std::string& name, int value)
+    void Shader::setUniform1i(UniformName name, int value)
     {
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
+
         glUniform1i(getUniformLocation(name), value);
     }
 
-    void Shader::setUniformMat4f(const std::string& name, glm::mat4& mat)
+    void Shader::setUniform1iv(UniformName name, int count, const int* values)
+    {
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
+
+        glUniform1iv(getUniformLocation(name), count, values);
+    }
+
+    void Shader::setUniformMat4f(UniformName name, const glm::mat4& mat)
     {
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
+
         glUniformMatrix4fv(getUniformLocation(name), 1, false, &mat[0][0]);
     }
 
-    int Shader::getUniformLocation(const std::string& name)
+    void Shader::setUniform4f(UniformHandle handle, glm::vec4 vec)
     {
-        if (uniformLocationCache.find(name) != uniformLocationCache.end())
-            return uniformLocationCache[name];
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
+
+        glUniform4f(getHandleLocation(handle), vec.x, vec.y, vec.z, vec.w);
+    }
 
-        int location = glGetUniformLocation(id, name.c_str());
+    void Shader::setUniform1i(UniformHandle handle, int value)
+    {
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
 
-        if (location == -1)
-            std::cout << "Warning: Uniform " << name << " doesn't exist!" << std::endl;
+        glUniform1i(getHandleLocation(handle), value);
+    }
 
-        uniformLocationCache[name] = location;
+    void Shader::setUniform1iv(UniformHandle handle, int count, const int* values)
+    {
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
 
-        return location;
+        glUniform1iv(getHandleLocation(handle), count, values);
     }
 
-    ShaderSource Shader::parseShader(const std::string& path)
+    void Shader::setUniformMat4f(UniformHandle handle, const glm::mat4& mat)
     {
-        // Open file
-        std::ifstream stream(path);
+        ProfileScope profile("Shader::setUniform");
+        RenderStats::countUniformUpload();
 
-        enum class ShaderType
+        glUniformMatrix4fv(getHandleLocation(handle), 1, false, &mat[0][0]);
+    }
+
+    int Shader::getUniformLocation(UniformName name)
+    {
+        return uniformSlots[getUniformSlot(name)].location;
+    }
+
+    int Shader::getUniformSlot(UniformName name)
+    {
+        // Names are compared too, two names can hash the same
+        auto range = uniformSlotCache.equal_range(name.hash);
+
+        for (auto it = range.first; it != range.second; ++it)
         {
-            NONE = -1, VERTEX = 0, FRAGMENT = 1
-        };
+            if (uniformSlots[it->second].name == name.name)
+                return it->second;
+        }
+
+        if (range.first != range.second)
+            std::cout << "Warning: Uniform " << name.name << " has the same hash as " << uniformSlots[range.first->second].name << "!" << std::endl;
 
-        // Declare string where to copy
-        std::stringstream ss[2];
-        ShaderType type = ShaderType::NONE;
+        // Otherwise resolved with the rest once the program links
+        bool linked = ready();
+
+        int slot = (int)uniformSlots.size();
+        uniformSlots.push_back({ name.name, -1 });
+        uniformSlotCache.emplace(name.hash, slot);
+
+        if (linked)
+            uniformSlots[slot].location = findUniformLocation(name);
+
+        return slot;
+    }
+
+    int Shader::findUniformLocation(UniformName name) const
+    {
+        if (const ShaderVariable* variable = reflection.findUniform(name.hash, name.name))
+            return variable->location;
 
-        // Read line from file
-        std::string line;
-        while (getline(stream, line))
+        // Only the first element of an array is in the tables
+        size_t length = strlen(name.name);
+
+        if (length > 0 && name.name[length - 1] == ']')
         {
-            // If line defines a shader change type
-            if (line.find("#shader") != std::string::npos)
-            {
-                if (line.find("vertex") != std::string::npos)
-                    type = ShaderType::VERTEX;
-                else if (line.find("fragment") != std::string::npos)
-                    type = ShaderType::FRAGMENT;
-            }
-            // Add line to shader string
-            else
-            {
-                if (type != ShaderType::NONE)
-                    ss[(int)type] << line << '\n';
-            }
+            int location = glGetUniformLocation(id, name.name);
+
+            if (location != -1)
+                return location;
         }
 
-        return { ss[0].str(), ss[1].str() };
+        std::cout << "Warning: Uniform " << name.name << " doesn't exist!" << std::endl;
+
+        return -1;
     }
 
-    unsigned int Shader::compileShader(unsigned int type, const std::string& source)
+    void Shader::reflectProgram()
     {
-        unsigned int id = glCreateShader(type);
-        const char* src = source.c_str();
+        reflection.reflect(id);
 
-        glShaderSource(id, 1, &src, nullptr);
-        glCompileShader(id);
+        for (UniformSlot& uniform : uniformSlots)
+            uniform.location = findUniformLocation(uniform.name);
+    }
 
-        int result;
-        glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    bool Shader::validateLayout(const VertexBufferLayout& layout)
+    {
+        return validateLayouts({ &layout });
+    }
 
-        // Error handling
-        if (result == GL_FALSE)
+    bool Shader::validateLayouts(const std::vector<const VertexBufferLayout*>& layouts)
+    {
+        if (!ready())
         {
-            int length;
-            glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+            std::cout << "Can not validate vertex layout of " << path << ", program is not linked!" << std::endl;
+            return false;
+        }
 
-            char* message = (char*)alloca(length * sizeof(char));
-            glGetShaderInfoLog(id, length, &length, message);
+        return reflection.validateLayouts(layouts, path);
+    }
 
-            std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex " : "fragment ") << "shader!" << std::endl;
-            std::cout << message << std::endl;
+    void Shader::create(const ShaderSourceView& source, ShaderCompileMode mode)
+    {
+        bool cached;
+        id = loadProgram(source, cached);
+
+        if (cached)
+            state = ShaderState::READY;
+        else if (mode == ShaderCompileMode::BLOCKING)
+            state = finishProgram(id) ? ShaderState::READY : ShaderState::FAILED;
+
+        if (state == ShaderState::READY)
+            reflectProgram();
+    }
+
+    unsigned int Shader::loadProgram(const ShaderSourceView& source, bool& cached)
+    {
+        ProfileScope profile("Shader::loadProgram");
+
+        cached = false;
+        storeInCache = false;
+
+        if (!programCache || !programCache->isEnabled())
+            return createShader(source.vertexSource, source.fragmentSource);
+
+        uint64_t key = programCache->makeKey(source.vertexSource, source.fragmentSource);
+        unsigned int program = programCache->load(key);
 
-            glDeleteShader(id);
-            return 0;
+        if (program)
+        {
+            // Block bindings are not guaranteed to survive in the binary
+            UniformBuffer::bindBlocks(program);
+            cached = true;
+            return program;
         }
 
+        // Stored once the link is known to have succeeded
+        storeInCache = true;
+        cacheKey = key;
+
+        return createShader(source.vertexSource, source.fragmentSource);
+    }
+
+    ShaderPreprocessor& Shader::getPreprocessor()
+    {
+        static ShaderPreprocessor preprocessor;
+        return preprocessor;
+    }
+
+    ShaderSource Shader::parseSource(const std::string& text)
+    {
+        ShaderSourceView stages = splitShaderSource(text);
+
+        return { std::string(stages.vertexSource), std::string(stages.fragmentSource) };
+    }
+
+    unsigned int Shader::compileShader(unsigned int type, std::string_view source)
+    {
+        ProfileScope profile("Shader::compileShader");
+
+        unsigned int id = glCreateShader(type);
+        const char* src = source.data();
+        int length = (int)source.size();
+
+        // Explicit length, the slice is not null terminated
+        glShaderSource(id, 1, &src, &length);
+        glCompileShader(id);
+
+        // Status is checked in finishProgram so the driver is not forced to wait
         return id;
     }
 
-	unsigned int Shader::createShader(const std::string& vertexShaderCode, const std::string& fragmentShaderCode)
+	unsigned int Shader::createShader(std::string_view vertexShaderCode, std::string_view fragmentShaderCode)
 	{
+		ProfileScope profile("Shader::createShader");
+
 		unsigned int program = glCreateProgram();
 
-		unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderCode);
-		unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderCode);
+		vertexShader = compileShader(GL_VERTEX_SHADER, vertexShaderCode);
+		fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentShaderCode);
 
 		glAttachShader(program, vertexShader);
 		glAttachShader(program, fragmentShader);
 
-		glLinkProgram(program);
-		glValidateProgram(program);
+		// Allow the program cache to read the binary back
+		if (storeInCache)
+			GLExtensions::programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
+		glLinkProgram(program);
 
 		return program;
 	}
-}
\ No newline at end of file
+
+    bool Shader::linkCompleted(unsigned int program) const
+    {
+        if (!GLExtensions::hasParallelShaderCompile)
+            return true;
+
+        int completed = GL_FALSE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+
+        return completed != GL_FALSE;
+    }
+
+    void Shader::swapProgram()
+    {
+        // Keep what was set on the old program, reload must not reset the scene
+        if (state == ShaderState::READY)
+            copyUniforms(id, pendingId);
+
+        GLStateCache::deleteProgram(id);
+
+        id = pendingId;
+        pendingId = 0;
+        state = ShaderState::READY;
+
+        reflectProgram();
+
+        std::cout << "Reloaded " << path << std::endl;
+    }
+
+    void Shader::copyUniforms(unsigned int from, unsigned int to)
+    {
+        int count = 0;
+        glGetProgramiv(from, GL_ACTIVE_UNIFORMS, &count);
+
+        GLStateCache::useProgram(to);
+
+        for (int i = 0; i < count; i++)
+        {
+            char name[256];
+            int length, size;
+            unsigned int type;
+            glGetActiveUniform(from, i, sizeof(name), &length, &size, &type, name);
+
+            // Array elements are queried one at a time, the name comes as name[0]
+            std::string baseName(name, length);
+
+            if (size > 1 && baseName.size() > 3 && baseName.compare(baseName.size() - 3, 3, "[0]") == 0)
+                baseName.resize(baseName.size() - 3);
+
+            for (int element = 0; element < size; element++)
+            {
+                std::string elementName = size > 1 ? baseName + "[" + std::to_string(element) + "]" : baseName;
+
+                // Members of uniform blocks have no location
+                int source = glGetUniformLocation(from, elementName.c_str());
+                int target = glGetUniformLocation(to, elementName.c_str());
+
+                if (source == -1 || target == -1)
+                    continue;
+
+                float floats[16];
+                int ints[4];
+                unsigned int uints[4];
+
+                switch (type)
+                {
+                    case GL_FLOAT:             glGetUniformfv(from, source, floats); glUniform1fv(target, 1, floats); break;
+                    case GL_FLOAT_VEC2:        glGetUniformfv(from, source, floats); glUniform2fv(target, 1, floats); break;
+                    case GL_FLOAT_VEC3:        glGetUniformfv(from, source, floats); glUniform3fv(target, 1, floats); break;
+                    case GL_FLOAT_VEC4:        glGetUniformfv(from, source, floats); glUniform4fv(target, 1, floats); break;
+                    case GL_FLOAT_MAT2:        glGetUniformfv(from, source, floats); glUniformMatrix2fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT3:        glGetUniformfv(from, source, floats); glUniformMatrix3fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT4:        glGetUniformfv(from, source, floats); glUniformMatrix4fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT2x3:      glGetUniformfv(from, source, floats); glUniformMatrix2x3fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT2x4:      glGetUniformfv(from, source, floats); glUniformMatrix2x4fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT3x2:      glGetUniformfv(from, source, floats); glUniformMatrix3x2fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT3x4:      glGetUniformfv(from, source, floats); glUniformMatrix3x4fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT4x2:      glGetUniformfv(from, source, floats); glUniformMatrix4x2fv(target, 1, false, floats); break;
+                    case GL_FLOAT_MAT4x3:      glGetUniformfv(from, source, floats); glUniformMatrix4x3fv(target, 1, false, floats); break;
+
+                    // Booleans are set through the int functions
+                    case GL_INT:
+                    case GL_BOOL:              glGetUniformiv(from, source, ints);   glUniform1iv(target, 1, ints); break;
+                    case GL_INT_VEC2:
+                    case GL_BOOL_VEC2:         glGetUniformiv(from, source, ints);   glUniform2iv(target, 1, ints); break;
+                    case GL_INT_VEC3:
+                    case GL_BOOL_VEC3:         glGetUniformiv(from, source, ints);   glUniform3iv(target, 1, ints); break;
+                    case GL_INT_VEC4:
+                    case GL_BOOL_VEC4:         glGetUniformiv(from, source, ints);   glUniform4iv(target, 1, ints); break;
+
+                    case GL_UNSIGNED_INT:      glGetUniformuiv(from, source, uints); glUniform1uiv(target, 1, uints); break;
+                    case GL_UNSIGNED_INT_VEC2: glGetUniformuiv(from, source, uints); glUniform2uiv(target, 1, uints); break;
+                    case GL_UNSIGNED_INT_VEC3: glGetUniformuiv(from, source, uints); glUniform3uiv(target, 1, uints); break;
+                    case GL_UNSIGNED_INT_VEC4: glGetUniformuiv(from, source, uints); glUniform4uiv(target, 1, uints); break;
+
+                    default:
+                    {
+                        if (isSamplerType(type))
+                        {
+                            glGetUniformiv(from, source, ints);
+                            glUniform1iv(target, 1, ints);
+                        }
+                        else
+                        {
+                            std::cout << "Warning: Uniform " << elementName << " of type 0x" << std::hex << type << std::dec
+                                << " is not carried over to the reloaded program!" << std::endl;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    bool Shader::finishProgram(unsigned int program)
+    {
+        ProfileScope profile("Shader::finishProgram");
+
+        bool compiled = checkShader(vertexShader, GL_VERTEX_SHADER);
+        compiled = checkShader(fragmentShader, GL_FRAGMENT_SHADER) && compiled;
+
+        int linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+        // Link errors only make sense when both stages compiled
+        if (compiled && linked == GL_FALSE)
+        {
+            int length;
+            glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+
+            std::vector<char> message(length + 1);
+            glGetProgramInfoLog(program, length, &length, message.data());
+
+            std::cout << "Failed to link " << path << "!" << std::endl;
+            std::cout << message.data() << std::endl;
+        }
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        vertexShader = 0;
+        fragmentShader = 0;
+
+        if (!compiled || linked == GL_FALSE)
+            return false;
+
+        // Shared uniform blocks
+        UniformBuffer::bindBlocks(program);
+
+        if (storeInCache)
+            programCache->store(program, cacheKey);
+
+        return true;
+    }
+
+    bool Shader::checkShader(unsigned int shader, unsigned int type)
+    {
+        int result;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &result);
+
+        // Error handling
+        if (result == GL_FALSE)
+        {
+            int length;
+            glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+
+            std::vector<char> message(length + 1);
+            glGetShaderInfoLog(shader, length, &length, message.data());
+
+            std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex " : "fragment ") << "shader!" << std::endl;
+            std::cout << message.data() << std::endl;
+
+            return false;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,148 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "ShaderCache.h"
+#include "GLExtensions.h"
+#include "Hash.h"
+
+namespace mg
+{
+	// Header of every cache file
+	struct ProgramBinaryHeader
+	{
+		uint32_t magic;
+		uint32_t format;
+		uint32_t length;
+		uint32_t reserved;
+	};
+
+	static const uint32_t PROGRAM_BINARY_MAGIC = 0x4250474D; // "MGPB"
+
+	ShaderCache::ShaderCache(const std::string& cacheDirectory)
+		: directory(cacheDirectory), enabled(GLExtensions::hasProgramBinary)
+	{
+		driver  = (const char*)glGetString(GL_VENDOR);
+		driver += '|';
+		driver += (const char*)glGetString(GL_RENDERER);
+		driver += '|';
+		driver += (const char*)glGetString(GL_VERSION);
+
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+
+		if (error)
+		{
+			std::cout << "Warning: Shader cache directory " << directory << " could not be created!" << std::endl;
+			enabled = false;
+		}
+	}
+
+	uint64_t ShaderCache::makeKey(std::string_view vertexSource, std::string_view fragmentSource) const
+	{
+		uint64_t hash = fnv1a64(driver.data(), driver.size());
+		hash = fnv1a64(vertexSource.data(), vertexSource.size(), hash);
+
+		// Keep "ab" + "c" and "a" + "bc" apart
+		hash = fnv1a64("\0", 1, hash);
+		hash = fnv1a64(fragmentSource.data(), fragmentSource.size(), hash);
+
+		return hash;
+	}
+
+	unsigned int ShaderCache::load(uint64_t key) const
+	{
+		if (!enabled)
+			return 0;
+
+		std::string filePath = getFilePath(key);
+		std::ifstream stream(filePath, std::ios::binary);
+
+		if (!stream)
+			return 0;
+
+		ProgramBinaryHeader header = {};
+		stream.read((char*)&header, sizeof(header));
+
+		std::vector<char> binary;
+
+		if (stream && header.magic == PROGRAM_BINARY_MAGIC)
+		{
+			binary.resize(header.length);
+			stream.read(binary.data(), header.length);
+		}
+
+		stream.close();
+
+		unsigned int program = 0;
+		int linked = GL_FALSE;
+
+		if (!binary.empty() && binary.size() == header.length)
+		{
+			program = glCreateProgram();
+			GLExtensions::programBinary(program, header.format, binary.data(), header.length);
+			glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		}
+
+		// Stale or truncated, forget it so the next store replaces it
+		if (linked == GL_FALSE)
+		{
+			if (program)
+				glDeleteProgram(program);
+
+			std::remove(filePath.c_str());
+			return 0;
+		}
+
+		return program;
+	}
+
+	void ShaderCache::store(unsigned int program, uint64_t key) const
+	{
+		if (!enabled)
+			return;
+
+		int linked = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+		int length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+		if (linked == GL_FALSE || length <= 0)
+			return;
+
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		GLExtensions::getProgramBinary(program, length, &length, &format, binary.data());
+
+		ProgramBinaryHeader header = { PROGRAM_BINARY_MAGIC, format, (uint32_t)length, 0 };
+
+		// Write aside and rename so a crash never leaves a truncated entry
+		std::string filePath = getFilePath(key);
+		std::string tempPath = filePath + ".tmp";
+
+		{
+			std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+			stream.write((const char*)&header, sizeof(header));
+			stream.write(binary.data(), length);
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, filePath, error);
+	}
+
+	std::string ShaderCache::getFilePath(uint64_t key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+		return (std::filesystem::path(directory) / name).string();
+	}
+}
@@ -0,0 +1,91 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cstdio>
+#include <cstring>
+
+#include "ShaderParser.h"
+
+namespace mg
+{
+	bool readTextFile(const std::string& path, std::string& contents)
+	{
+		FILE* file = std::fopen(path.c_str(), "rb");
+
+		if (!file)
+			return false;
+
+		std::fseek(file, 0, SEEK_END);
+		long size = std::ftell(file);
+		std::fseek(file, 0, SEEK_SET);
+
+		if (size < 0)
+		{
+			std::fclose(file);
+			return false;
+		}
+
+		contents.resize((size_t)size);
+		size_t read = size > 0 ? std::fread(&contents[0], 1, (size_t)size, file) : 0;
+		contents.resize(read);
+
+		std::fclose(file);
+		return true;
+	}
+
+	ShaderSourceView splitShaderSource(std::string_view text)
+	{
+		enum class ShaderType
+		{
+			NONE = -1, VERTEX = 0, FRAGMENT = 1
+		};
+
+		std::string_view stages[2];
+
+		ShaderType type = ShaderType::NONE;
+		size_t sectionStart = 0;
+
+		const char* data = text.data();
+		const size_t size = text.size();
+
+		size_t lineStart = 0;
+
+		while (lineStart < size)
+		{
+			const char* newline = (const char*)std::memchr(data + lineStart, '\n', size - lineStart);
+			size_t lineEnd = newline ? (size_t)(newline - data) : size;
+
+			size_t first = lineStart;
+
+			while (first < lineEnd && (data[first] == ' ' || data[first] == '\t'))
+				first++;
+
+			// Marker line closes the previous section and opens a new one
+			if (lineEnd - first >= 7 && std::memcmp(data + first, "#shader", 7) == 0)
+			{
+				if (type != ShaderType::NONE)
+					stages[(int)type] = text.substr(sectionStart, lineStart - sectionStart);
+
+				std::string_view marker = text.substr(first + 7, lineEnd - first - 7);
+
+				if (marker.find("vertex") != std::string_view::npos)
+					type = ShaderType::VERTEX;
+				else if (marker.find("fragment") != std::string_view::npos)
+					type = ShaderType::FRAGMENT;
+				else
+					type = ShaderType::NONE;
+
+				sectionStart = lineEnd + 1 < size ? lineEnd + 1 : size;
+			}
+
+			lineStart = lineEnd + 1;
+		}
+
+		if (type != ShaderType::NONE)
+			stages[(int)type] = text.substr(sectionStart);
+
+		return { stages[0], stages[1] };
+	}
+}
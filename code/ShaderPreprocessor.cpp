@@ -0,0 +1,154 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+#include "ShaderPreprocessor.h"
+#include "ShaderParser.h"
+
+namespace mg
+{
+	std::string ShaderPreprocessor::process(const std::string& path)
+	{
+		std::string output;
+		std::unordered_set<std::string> included;
+
+		dependencies.clear();
+
+		if (!expand(path, output, included))
+			return std::string();
+
+		return output;
+	}
+
+	void ShaderPreprocessor::clearCache()
+	{
+		fileCache.clear();
+	}
+
+	std::string ShaderPreprocessor::injectDefines(const std::string& stageSource, const std::vector<std::string>& defines)
+	{
+		if (defines.empty())
+			return stageSource;
+
+		std::string block;
+
+		for (const std::string& define : defines)
+			block += "#define " + define + "\n";
+
+		// #version has to stay the first directive
+		size_t version = stageSource.find("#version");
+
+		if (version == std::string::npos)
+			return block + stageSource;
+
+		size_t lineEnd = stageSource.find('\n', version);
+
+		if (lineEnd == std::string::npos)
+			return stageSource + "\n" + block;
+
+		std::string result;
+		result.reserve(stageSource.size() + block.size());
+		result.append(stageSource, 0, lineEnd + 1);
+		result += block;
+		result.append(stageSource, lineEnd + 1, std::string::npos);
+
+		return result;
+	}
+
+	bool ShaderPreprocessor::expand(const std::string& path, std::string& output, std::unordered_set<std::string>& included)
+	{
+		std::string key = std::filesystem::path(path).lexically_normal().generic_string();
+
+		// Already pasted in this expansion
+		if (!included.insert(key).second)
+			return true;
+
+		const std::string* contents = readFile(key);
+
+		if (!contents)
+		{
+			std::cout << "Failed to open shader file " << path << "!" << std::endl;
+			return false;
+		}
+
+		if (std::find(dependencies.begin(), dependencies.end(), key) == dependencies.end())
+			dependencies.push_back(key);
+
+		std::filesystem::path directory = std::filesystem::path(key).parent_path();
+
+		// Lines without an include are copied in runs, not one at a time,
+		// and only lines holding a '#' are looked at
+		size_t runStart = 0;
+		size_t position = 0;
+
+		while ((position = contents->find('#', position)) != std::string::npos)
+		{
+			size_t lineStart = contents->rfind('\n', position);
+			lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+
+			size_t lineEnd = contents->find('\n', position);
+
+			if (lineEnd == std::string::npos)
+				lineEnd = contents->size();
+
+			// Directives only have blanks before them
+			bool directive = contents->find_first_not_of(" \t", lineStart) == position;
+
+			if (directive && contents->compare(position, 8, "#include") == 0)
+			{
+				size_t open = contents->find_first_of("\"<", position + 8);
+				size_t close = open < lineEnd ? contents->find_first_of("\">", open + 1) : std::string::npos;
+
+				if (open >= lineEnd || close >= lineEnd)
+				{
+					std::cout << "Malformed #include in " << path << "!" << std::endl;
+					return false;
+				}
+
+				output.append(*contents, runStart, lineStart - runStart);
+				runStart = std::min(lineEnd + 1, contents->size());
+
+				std::string includePath = (directory / contents->substr(open + 1, close - open - 1)).string();
+
+				if (!expand(includePath, output, included))
+					return false;
+			}
+			// Every stage is compiled on its own and needs its own copy of the includes
+			else if (directive && contents->compare(position, 7, "#shader") == 0)
+			{
+				included.clear();
+				included.insert(key);
+			}
+
+			position = lineEnd;
+		}
+
+		output.append(*contents, runStart, std::string::npos);
+
+		// Last line without a newline, the next file must start on its own line
+		if (runStart < contents->size() && contents->back() != '\n')
+			output += '\n';
+
+		return true;
+	}
+
+	const std::string* ShaderPreprocessor::readFile(const std::string& path)
+	{
+		auto it = fileCache.find(path);
+
+		if (it != fileCache.end())
+			return &it->second;
+
+		std::string contents;
+
+		if (!readTextFile(path, contents))
+			return nullptr;
+
+		return &fileCache.emplace(path, std::move(contents)).first->second;
+	}
+}
@@ -0,0 +1,246 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include "ShaderReflection.h"
+#include "VertexBufferLayout.h"
+#include "Hash.h"
+
+namespace mg
+{
+	// Sort entries by hash and split them in the table and its names
+	template<typename T>
+	static void buildTable(std::vector<std::pair<T, std::string>>& entries, std::vector<T>& table, std::vector<std::string>& names)
+	{
+		std::sort(entries.begin(), entries.end(),
+			[](const std::pair<T, std::string>& a, const std::pair<T, std::string>& b) { return a.first.hash < b.first.hash; });
+
+		table.clear();
+		names.clear();
+
+		table.reserve(entries.size());
+		names.reserve(entries.size());
+
+		for (auto& entry : entries)
+		{
+			// Both are kept, lookups tell them apart by name
+			if (!table.empty() && table.back().hash == entry.first.hash)
+				std::cout << "Warning: Shader names " << names.back() << " and " << entry.second << " have the same hash!" << std::endl;
+
+			table.push_back(entry.first);
+			names.push_back(std::move(entry.second));
+		}
+	}
+
+	// Entries with equal hashes are next to each other, the name picks one
+	template<typename T>
+	static const T* findInTable(const std::vector<T>& table, const std::vector<std::string>& names, uint32_t hash, const char* name)
+	{
+		auto it = std::lower_bound(table.begin(), table.end(), hash,
+			[](const T& entry, uint32_t value) { return entry.hash < value; });
+
+		for (; it != table.end() && it->hash == hash; ++it)
+		{
+			if (names[it - table.begin()] == name)
+				return &*it;
+		}
+
+		return nullptr;
+	}
+
+	void ShaderReflection::reflect(unsigned int program)
+	{
+		int count = 0;
+		int maxLength = 0;
+
+		// Uniforms
+		std::vector<std::pair<ShaderVariable, std::string>> foundUniforms;
+
+		glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+		std::vector<char> name(maxLength + 1);
+
+		for (int i = 0; i < count; i++)
+		{
+			int length, size;
+			unsigned int type;
+			glGetActiveUniform(program, i, maxLength + 1, &length, &size, &type, name.data());
+
+			// Members of uniform blocks are set through the buffer
+			int location = glGetUniformLocation(program, name.data());
+
+			if (location == -1)
+				continue;
+
+			std::string uniformName(name.data(), length);
+			foundUniforms.push_back({ { fnv1a32(uniformName.data(), uniformName.size()), location, (unsigned int)type, size }, uniformName });
+
+			// Arrays are reported as name[0] but can be set by their plain name too
+			if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+			{
+				uniformName.resize(uniformName.size() - 3);
+				foundUniforms.push_back({ { fnv1a32(uniformName.data(), uniformName.size()), location, (unsigned int)type, size }, uniformName });
+			}
+		}
+
+		buildTable(foundUniforms, uniforms, uniformNames);
+
+		// Attributes
+		std::vector<std::pair<ShaderVariable, std::string>> foundAttributes;
+
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+		glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+
+		name.resize(maxLength + 1);
+
+		for (int i = 0; i < count; i++)
+		{
+			int length, size;
+			unsigned int type;
+			glGetActiveAttrib(program, i, maxLength + 1, &length, &size, &type, name.data());
+
+			// Built in inputs like gl_VertexID have no location
+			int location = glGetAttribLocation(program, name.data());
+
+			if (location == -1)
+				continue;
+
+			std::string attributeName(name.data(), length);
+			foundAttributes.push_back({ { fnv1a32(attributeName.data(), attributeName.size()), location, (unsigned int)type, size }, attributeName });
+		}
+
+		buildTable(foundAttributes, attributes, attributeNames);
+
+		// Uniform blocks
+		std::vector<std::pair<ShaderBlock, std::string>> foundBlocks;
+
+		glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+
+		for (int i = 0; i < count; i++)
+		{
+			int length, binding, dataSize;
+			glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &length);
+			glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &binding);
+			glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize);
+
+			name.resize(length + 1);
+			glGetActiveUniformBlockName(program, i, length + 1, &length, name.data());
+
+			std::string blockName(name.data(), length);
+			foundBlocks.push_back({ { fnv1a32(blockName.data(), blockName.size()), (unsigned int)i, (unsigned int)binding, dataSize }, blockName });
+		}
+
+		buildTable(foundBlocks, blocks, blockNames);
+	}
+
+	const ShaderVariable* ShaderReflection::findUniform(uint32_t hash, const char* name) const
+	{
+		return findInTable(uniforms, uniformNames, hash, name);
+	}
+
+	const ShaderVariable* ShaderReflection::findAttribute(uint32_t hash, const char* name) const
+	{
+		return findInTable(attributes, attributeNames, hash, name);
+	}
+
+	const ShaderBlock* ShaderReflection::findBlock(uint32_t hash, const char* name) const
+	{
+		return findInTable(blocks, blockNames, hash, name);
+	}
+
+	bool ShaderReflection::validateLayouts(const std::vector<const VertexBufferLayout*>& layouts, const std::string& shaderName) const
+	{
+		// Components fed to each location, same assignment as VertexArray
+		std::vector<unsigned int> fed;
+
+		for (const VertexBufferLayout* layout : layouts)
+		{
+			for (const VertexBufferElement& element : layout->getElements())
+			{
+				for (unsigned int component = 0; component < element.count; component += 4)
+					fed.push_back(element.count - component < 4 ? element.count - component : 4);
+			}
+		}
+
+		std::vector<bool> read(fed.size(), false);
+		bool valid = true;
+
+		for (size_t i = 0; i < attributes.size(); i++)
+		{
+			const ShaderVariable& attribute = attributes[i];
+			unsigned int locations = getLocationCount(attribute.type) * attribute.size;
+
+			for (unsigned int column = 0; column < locations; column++)
+			{
+				unsigned int location = attribute.location + column;
+
+				// Missing components are filled with (0, 0, 0, 1), only a missing location is an error
+				if (location >= fed.size())
+				{
+					std::cout << "Attribute " << attributeNames[i] << " at location " << location << " of " << shaderName << " has no data in the vertex layout!" << std::endl;
+					valid = false;
+					continue;
+				}
+
+				if (isIntegerType(attribute.type))
+				{
+					std::cout << "Attribute " << attributeNames[i] << " of " << shaderName << " is an integer, vertex layouts are read as floats!" << std::endl;
+					valid = false;
+				}
+
+				read[location] = true;
+			}
+		}
+
+		for (size_t location = 0; location < fed.size(); location++)
+		{
+			if (!read[location])
+				std::cout << "Warning: Vertex layout data at location " << location << " is not read by " << shaderName << "!" << std::endl;
+		}
+
+		return valid;
+	}
+
+	unsigned int ShaderReflection::getLocationCount(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_FLOAT_MAT2:
+			case GL_FLOAT_MAT2x3:
+			case GL_FLOAT_MAT2x4:	return 2;
+			case GL_FLOAT_MAT3:
+			case GL_FLOAT_MAT3x2:
+			case GL_FLOAT_MAT3x4:	return 3;
+			case GL_FLOAT_MAT4:
+			case GL_FLOAT_MAT4x2:
+			case GL_FLOAT_MAT4x3:	return 4;
+		}
+
+		return 1;
+	}
+
+	bool ShaderReflection::isIntegerType(unsigned int type)
+	{
+		switch (type)
+		{
+			case GL_INT:
+			case GL_INT_VEC2:
+			case GL_INT_VEC3:
+			case GL_INT_VEC4:
+			case GL_UNSIGNED_INT:
+			case GL_UNSIGNED_INT_VEC2:
+			case GL_UNSIGNED_INT_VEC3:
+			case GL_UNSIGNED_INT_VEC4:	return true;
+		}
+
+		return false;
+	}
+}
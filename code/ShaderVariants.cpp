@@ -0,0 +1,72 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cassert>
+
+#include "ShaderVariants.h"
+#include "ShaderPreprocessor.h"
+
+namespace mg
+{
+	ShaderVariants::ShaderVariants(const std::string& shaderPath, const std::vector<std::string>& variantKeywords, ShaderCompileMode mode)
+		: path(shaderPath), keywords(variantKeywords), compileMode(mode)
+	{
+		assert(keywords.size() <= 32);
+
+		source = Shader::parseSource(Shader::getPreprocessor().process(path));
+	}
+
+	Shader& ShaderVariants::get(uint32_t mask)
+	{
+		auto it = variants.find(mask);
+
+		if (it != variants.end())
+			return *it->second;
+
+		std::vector<std::string> defines;
+		std::string name = path;
+
+		for (size_t i = 0; i < keywords.size(); i++)
+		{
+			if (mask & (1u << i))
+			{
+				defines.push_back(keywords[i]);
+				name += "|" + keywords[i];
+			}
+		}
+
+		ShaderSource variantSource =
+		{
+			ShaderPreprocessor::injectDefines(source.vertexSource, defines),
+			ShaderPreprocessor::injectDefines(source.fragmentSource, defines)
+		};
+
+		auto shader = std::make_unique<Shader>(variantSource, name, compileMode);
+
+		return *variants.emplace(mask, std::move(shader)).first->second;
+	}
+
+	void ShaderVariants::precompile(const std::vector<uint32_t>& masks)
+	{
+		for (uint32_t mask : masks)
+			get(mask);
+	}
+
+	uint32_t ShaderVariants::getMask(const std::vector<std::string>& enabledKeywords) const
+	{
+		uint32_t mask = 0;
+
+		for (const std::string& keyword : enabledKeywords)
+		{
+			for (size_t i = 0; i < keywords.size(); i++)
+			{
+				if (keywords[i] == keyword)
+					mask |= 1u << i;
+			}
+		}
+
+		return mask;
+	}
+}
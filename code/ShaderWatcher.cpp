@@ -0,0 +1,284 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "ShaderWatcher.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+
+namespace mg
+{
+	ShaderWatcher::ShaderWatcher()
+		: running(true)
+	{
+#ifdef __linux__
+		inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (inotifyDescriptor == -1)
+			std::cout << "Warning: Could not create inotify instance, polling shader files instead!" << std::endl;
+#endif
+
+		thread = std::thread(&ShaderWatcher::run, this);
+	}
+
+	ShaderWatcher::~ShaderWatcher()
+	{
+		running = false;
+
+		if (thread.joinable())
+			thread.join();
+
+#ifdef __linux__
+		if (inotifyDescriptor != -1)
+			close(inotifyDescriptor);
+#endif
+	}
+
+	void ShaderWatcher::watch(Shader& shader)
+	{
+		// Own preprocessor, the one of the watcher thread is not shared
+		ShaderPreprocessor files;
+
+		if (files.process(shader.getPath()).empty())
+		{
+			std::cout << "Warning: Can not watch " << shader.getPath() << ", it is not a readable file!" << std::endl;
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::vector<std::string>& shaderFiles = watched[&shader];
+		shaderFiles = files.getDependencies();
+
+		addFiles(shaderFiles);
+	}
+
+	void ShaderWatcher::unwatch(Shader& shader)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			watched.erase(&shader);
+
+			reloads.erase(std::remove_if(reloads.begin(), reloads.end(),
+				[&](const Reload& reload) { return reload.shader == &shader; }), reloads.end());
+		}
+
+		compiling.erase(std::remove(compiling.begin(), compiling.end(), &shader), compiling.end());
+	}
+
+	void ShaderWatcher::update()
+	{
+		std::vector<Reload> started;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			started.swap(reloads);
+		}
+
+		// Files changed on disk, shaders created from now on read them again
+		if (!started.empty())
+			Shader::getPreprocessor().clearCache();
+
+		for (Reload& reload : started)
+		{
+			reload.shader->reload(reload.text);
+
+			// Programs loaded from the cache are swapped in right away
+			if (reload.shader->isReloading() && std::find(compiling.begin(), compiling.end(), reload.shader) == compiling.end())
+				compiling.push_back(reload.shader);
+		}
+
+		compiling.erase(std::remove_if(compiling.begin(), compiling.end(),
+			[](Shader* shader) { return !shader->updateReload(); }), compiling.end());
+	}
+
+	void ShaderWatcher::run()
+	{
+		while (running)
+		{
+			std::unordered_set<std::string> changedFiles = waitForChanges();
+
+			if (!changedFiles.empty())
+				reloadChanged(changedFiles);
+		}
+	}
+
+	std::unordered_set<std::string> ShaderWatcher::waitForChanges()
+	{
+#ifdef __linux__
+		if (inotifyDescriptor != -1)
+			return waitForEvents();
+#endif
+
+		return pollWriteTimes();
+	}
+
+	void ShaderWatcher::addFiles(const std::vector<std::string>& files)
+	{
+#ifdef __linux__
+		if (inotifyDescriptor != -1)
+		{
+			addWatches(files);
+			return;
+		}
+#endif
+
+		addWriteTimes(files);
+	}
+
+#ifdef __linux__
+
+	std::unordered_set<std::string> ShaderWatcher::waitForEvents()
+	{
+		std::unordered_set<std::string> changedFiles;
+
+		// Timeout only to notice the watcher is being destroyed
+		pollfd descriptor = { inotifyDescriptor, POLLIN, 0 };
+
+		if (poll(&descriptor, 1, 100) <= 0)
+			return changedFiles;
+
+		// Editors save in several steps, let them finish before reading
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+		alignas(inotify_event) char buffer[4096];
+		ssize_t length;
+
+		while ((length = read(inotifyDescriptor, buffer, sizeof(buffer))) > 0)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for (char* position = buffer; position < buffer + length; )
+			{
+				const inotify_event* event = (const inotify_event*)position;
+				position += sizeof(inotify_event) + event->len;
+
+				auto directory = directories.find(event->wd);
+
+				if (event->len == 0 || directory == directories.end())
+					continue;
+
+				std::filesystem::path file = std::filesystem::path(directory->second) / event->name;
+				changedFiles.insert(file.lexically_normal().generic_string());
+			}
+		}
+
+		return changedFiles;
+	}
+
+	void ShaderWatcher::addWatches(const std::vector<std::string>& files)
+	{
+		for (const std::string& file : files)
+		{
+			std::string directory = std::filesystem::path(file).parent_path().generic_string();
+
+			if (directory.empty())
+				directory = ".";
+
+			// Saving through a temporary file replaces the watched file,
+			// watching the directory catches both ways of saving
+			int watch = inotify_add_watch(inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+			if (watch == -1)
+				std::cout << "Warning: Can not watch directory " << directory << "!" << std::endl;
+			else
+				directories[watch] = directory;
+		}
+	}
+
+#endif
+
+	std::unordered_set<std::string> ShaderWatcher::pollWriteTimes()
+	{
+		std::unordered_set<std::string> changedFiles;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for (auto& [file, writeTime] : writeTimes)
+		{
+			std::error_code error;
+			std::filesystem::file_time_type time = std::filesystem::last_write_time(file, error);
+
+			if (!error && time != writeTime)
+			{
+				writeTime = time;
+				changedFiles.insert(file);
+			}
+		}
+
+		return changedFiles;
+	}
+
+	void ShaderWatcher::addWriteTimes(const std::vector<std::string>& files)
+	{
+		for (const std::string& file : files)
+		{
+			if (writeTimes.count(file))
+				continue;
+
+			std::error_code error;
+			writeTimes[file] = std::filesystem::last_write_time(file, error);
+		}
+	}
+
+	void ShaderWatcher::reloadChanged(const std::unordered_set<std::string>& changedFiles)
+	{
+		std::vector<std::pair<Shader*, std::string>> affected;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for (const auto& [shader, files] : watched)
+			{
+				for (const std::string& file : files)
+				{
+					if (changedFiles.count(file))
+					{
+						affected.push_back({ shader, files.front() });
+						break;
+					}
+				}
+			}
+		}
+
+		// Included files may be among the changes, read everything again
+		preprocessor.clearCache();
+
+		for (const auto& [shader, path] : affected)
+		{
+			std::string text = preprocessor.process(path);
+
+			// E.g. removed while saving, the current program stays
+			if (text.empty())
+				continue;
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// Unwatched while the file was being read
+			auto it = watched.find(shader);
+
+			if (it == watched.end())
+				continue;
+
+			// Includes may have been added or removed
+			it->second = preprocessor.getDependencies();
+			addFiles(it->second);
+
+			reloads.push_back({ shader, std::move(text) });
+		}
+	}
+}
@@ -0,0 +1,221 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <iostream>
+
+#include "SpriteBatch.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "TextureAtlas.h"
+#include "TextureArray.h"
+#include "BindlessTextureTable.h"
+#include "RenderStats.h"
+
+namespace mg
+{
+	static uint32_t packColor(const glm::vec4& color)
+	{
+		glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+
+		return  (uint32_t)clamped.r
+			| ((uint32_t)clamped.g << 8)
+			| ((uint32_t)clamped.b << 16)
+			| ((uint32_t)clamped.a << 24);
+	}
+
+	SpriteBatch::SpriteBatch(Shader& spriteShader, unsigned int maxSpritesPerDraw)
+		: maxSprites(maxSpritesPerDraw), spriteCount(0), spriteCapacity(0), vertices(nullptr), textureSlots(), textureCount(0),
+		  textureArray(nullptr), bindlessTable(nullptr), bindlessFullReported(false), vertexBuffer(GL_ARRAY_BUFFER, maxSpritesPerDraw * 4 * sizeof(SpriteVertex)), shader(spriteShader), samplersSet(false), drawCalls(0)
+	{
+		VertexBufferLayout layout;
+		layout.push<float>(2);
+		layout.push<float>(2);
+		layout.push<unsigned char>(4);
+		layout.push<float>(1);
+
+		vertexArray.addBuffer(vertexBuffer, layout);
+
+		// Two triangles per quad
+		std::vector<unsigned int> indices(maxSprites * 6);
+
+		for (unsigned int i = 0; i < maxSprites; i++)
+		{
+			indices[i * 6 + 0] = i * 4 + 0;
+			indices[i * 6 + 1] = i * 4 + 1;
+			indices[i * 6 + 2] = i * 4 + 2;
+			indices[i * 6 + 3] = i * 4 + 2;
+			indices[i * 6 + 4] = i * 4 + 3;
+			indices[i * 6 + 5] = i * 4 + 0;
+		}
+
+		// Created while the vertex array is bound so it becomes part of its state
+		indexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+		vertexArray.unbind();
+	}
+
+	void SpriteBatch::begin(const glm::mat4& viewProjection)
+	{
+		drawCalls = 0;
+
+		// Sprites are dropped while the shader compiles
+		if (!shader.ready())
+			return;
+
+		shader.bind();
+
+		if (!samplersSet)
+		{
+			// Only the variant sampling texture units has the array
+			static constexpr UniformName textures = "u_Textures";
+
+			if (shader.getReflection().findUniform(textures.hash, textures.name))
+			{
+				int samplers[MAX_TEXTURE_SLOTS];
+
+				for (unsigned int i = 0; i < MAX_TEXTURE_SLOTS; i++)
+					samplers[i] = i;
+
+				shader.setUniform1iv(textures, MAX_TEXTURE_SLOTS, samplers);
+			}
+
+			samplersSet = true;
+		}
+
+		shader.setUniformMat4f("modelViewProjection", viewProjection);
+	}
+
+	void SpriteBatch::draw(Texture& texture, glm::vec2 position, glm::vec2 size, glm::vec4 color, glm::vec4 uvRect)
+	{
+		if ((vertices && spriteCount == spriteCapacity) || textureArray)
+			flush();
+
+		if (bindlessTable)
+		{
+			unsigned int index = bindlessTable->add(texture);
+
+			if (index != BindlessTextureTable::INVALID_INDEX)
+			{
+				writeQuad(position, size, color, uvRect, (float)index);
+			}
+			// The bindless shader reads no slots, the sprite can not fall back to one
+			else if (!bindlessFullReported)
+			{
+				std::cout << "Warning: Bindless texture table is full, sprites with new textures are not drawn!" << std::endl;
+				bindlessFullReported = true;
+			}
+
+			return;
+		}
+
+		// Find slot of texture or take a new one
+		unsigned int slot = 0;
+
+		while (slot < textureCount && textureSlots[slot] != &texture)
+			slot++;
+
+		if (slot == textureCount)
+		{
+			if (textureCount == MAX_TEXTURE_SLOTS)
+			{
+				flush();
+				slot = 0;
+			}
+
+			textureSlots[textureCount++] = &texture;
+		}
+
+		writeQuad(position, size, color, uvRect, (float)slot);
+	}
+
+	void SpriteBatch::draw(TextureAtlas& atlas, const AtlasRegion& region, glm::vec2 position, glm::vec2 size, glm::vec4 color)
+	{
+		draw(atlas.getTexture(), position, size, color, region.uvRect);
+	}
+
+	void SpriteBatch::draw(TextureArray& array, unsigned int layer, glm::vec2 position, glm::vec2 size, glm::vec4 color, glm::vec4 uvRect)
+	{
+		if ((vertices && spriteCount == spriteCapacity) || textureCount > 0 || (textureArray && textureArray != &array))
+			flush();
+
+		textureArray = &array;
+
+		writeQuad(position, size, color, uvRect, (float)layer);
+	}
+
+	void SpriteBatch::setBindlessTable(BindlessTextureTable* table)
+	{
+		flush();
+		bindlessTable = table;
+		bindlessFullReported = false;
+	}
+
+	void SpriteBatch::end()
+	{
+		flush();
+		vertexBuffer.endFrame();
+	}
+
+	void SpriteBatch::flush()
+	{
+		// Slots and the array are reset below even when nothing was written
+		size_t offset = vertices ? vertexBuffer.unmap(spriteCount * 4 * sizeof(SpriteVertex)) : 0;
+
+		if (vertices && spriteCount > 0 && samplersSet)
+		{
+			// Handles added while writing must be in the buffer before the draw reads them
+			if (bindlessTable)
+				bindlessTable->update();
+
+			if (textureArray)
+				textureArray->bind(0);
+
+			for (unsigned int i = 0; i < textureCount; i++)
+				textureSlots[i]->bind(i);
+
+			shader.bind();
+			vertexArray.bind();
+
+			// Attributes point at the start of the ring, offset is a multiple of the vertex size
+			GLint baseVertex = (GLint)(offset / sizeof(SpriteVertex));
+			glDrawElementsBaseVertex(GL_TRIANGLES, spriteCount * 6, GL_UNSIGNED_INT, nullptr, baseVertex);
+			drawCalls++;
+
+			RenderStats::countDraw(spriteCount * 6);
+		}
+
+		vertices = nullptr;
+		spriteCapacity = 0;
+		spriteCount = 0;
+		textureCount = 0;
+		textureArray = nullptr;
+	}
+
+	void SpriteBatch::writeQuad(glm::vec2 position, glm::vec2 size, glm::vec4 color, glm::vec4 uvRect, float textureSlot)
+	{
+		// Start writing a new block of the ring
+		if (!vertices)
+		{
+			const size_t quadSize = 4 * sizeof(SpriteVertex);
+			size_t available = 0;
+
+			vertices = (SpriteVertex*)vertexBuffer.map(quadSize, sizeof(SpriteVertex), available);
+			spriteCapacity = (unsigned int)(available / quadSize);
+
+			if (spriteCapacity > maxSprites)
+				spriteCapacity = maxSprites;
+		}
+
+		uint32_t packedColor = packColor(color);
+
+		SpriteVertex* quad = vertices + spriteCount * 4;
+
+		quad[0] = { { position.x,          position.y          }, { uvRect.x, uvRect.y }, packedColor, textureSlot };
+		quad[1] = { { position.x + size.x, position.y          }, { uvRect.z, uvRect.y }, packedColor, textureSlot };
+		quad[2] = { { position.x + size.x, position.y + size.y }, { uvRect.z, uvRect.w }, packedColor, textureSlot };
+		quad[3] = { { position.x,          position.y + size.y }, { uvRect.x, uvRect.w }, packedColor, textureSlot };
+
+		spriteCount++;
+	}
+}
@@ -0,0 +1,183 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cassert>
+
+#include "StreamingBuffer.h"
+#include "GLExtensions.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+
+namespace mg
+{
+	StreamingBuffer::StreamingBuffer(unsigned int bufferTarget, size_t bytesPerRegion, unsigned int regions)
+		: id(0), target(bufferTarget), regionSize(bytesPerRegion), regionCount(regions), region(0), regionOffset(0),
+		  mappedOffset(0), persistent(GLExtensions::hasBufferStorage), mappedData(nullptr), fences()
+	{
+		assert(regions > 0 && regions <= MAX_REGIONS);
+
+		size_t size = regionSize * regionCount;
+
+		glGenBuffers(1, &id);
+		bind();
+
+		if (persistent)
+		{
+			GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+			GLExtensions::bufferStorage(target, size, nullptr, flags);
+			mappedData = (unsigned char*)glMapBufferRange(target, 0, size, flags);
+
+			// Driver refused the mapping, immutable storage can not be orphaned
+			// so start again with a mutable buffer for the 3.3 path
+			if (!mappedData)
+			{
+				persistent = false;
+
+				GLStateCache::deleteBuffer(id);
+				glGenBuffers(1, &id);
+				bind();
+			}
+		}
+
+		if (!persistent)
+		{
+			glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+			stagingData.resize(size);
+		}
+	}
+
+	StreamingBuffer::~StreamingBuffer()
+	{
+		for (GLsync& fence : fences)
+		{
+			if (fence)
+				glDeleteSync(fence);
+		}
+
+		if (persistent)
+		{
+			bind();
+			glUnmapBuffer(target);
+		}
+
+		GLStateCache::deleteBuffer(id);
+	}
+
+	void StreamingBuffer::bind()
+	{
+		GLStateCache::bindBuffer(target, id);
+	}
+
+	void StreamingBuffer::unbind()
+	{
+		GLStateCache::bindBuffer(target, 0);
+	}
+
+	void* StreamingBuffer::map(size_t minSize, size_t alignment, size_t& available)
+	{
+		assert(minSize <= regionSize);
+
+		size_t regionStart = region * regionSize;
+		size_t offset = regionStart + regionOffset;
+
+		if (alignment > 1)
+			offset = (offset + alignment - 1) / alignment * alignment;
+
+		if (offset + minSize > regionStart + regionSize)
+		{
+			nextRegion();
+
+			regionStart = region * regionSize;
+			offset = regionStart;
+
+			if (alignment > 1)
+				offset = (offset + alignment - 1) / alignment * alignment;
+		}
+
+		mappedOffset = offset;
+		available = regionStart + regionSize - offset;
+
+		return (persistent ? mappedData : stagingData.data()) + offset;
+	}
+
+	size_t StreamingBuffer::unmap(size_t usedSize)
+	{
+		assert(mappedOffset + usedSize <= (region + 1) * regionSize);
+
+		// Coherent mapping makes writes visible, only the copy needs an upload
+		if (!persistent && usedSize > 0)
+		{
+			bind();
+			glBufferSubData(target, mappedOffset, usedSize, stagingData.data() + mappedOffset);
+		}
+
+		regionOffset = mappedOffset + usedSize - region * regionSize;
+
+		// Written through the mapping or copied, either way it crosses to the GPU
+		RenderStats::countBufferUpload(usedSize);
+
+		return mappedOffset;
+	}
+
+	void StreamingBuffer::endFrame()
+	{
+		if (regionOffset > 0)
+			nextRegion();
+	}
+
+	void StreamingBuffer::nextRegion()
+	{
+		// Draws issued so far read the current region
+		if (persistent)
+		{
+			if (fences[region])
+				glDeleteSync(fences[region]);
+
+			fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		region = (region + 1) % regionCount;
+		regionOffset = 0;
+
+		if (persistent)
+		{
+			waitRegion(region);
+		}
+		// Give the driver new storage instead of waiting for the old one
+		else if (region == 0)
+		{
+			bind();
+			glBufferData(target, regionSize * regionCount, nullptr, GL_STREAM_DRAW);
+		}
+	}
+
+	void StreamingBuffer::waitRegion(unsigned int index)
+	{
+		GLsync& fence = fences[index];
+
+		if (!fence)
+			return;
+
+		// Only blocks when the CPU is a full ring ahead of the GPU
+		GLbitfield flags = 0;
+		GLuint64 timeout = 0;
+
+		while (true)
+		{
+			GLenum result = glClientWaitSync(fence, flags, timeout);
+
+			if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+				break;
+
+			// Make sure the fence gets submitted before waiting on it
+			flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+			timeout = 1000000;
+		}
+
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
@@ -5,48 +5,405 @@
 
 #include <glad/glad.h>
 
-#include "other/stb_image.h"
+#include <iostream>
+
 #include "Texture.h"
+#include "ImageDecoder.h"
+#include "GLStateCache.h"
+#include "GLExtensions.h"
+#include "Mipmap.h"
+#include "Profiler.h"
 
 namespace mg
 {
-	Texture::Texture(const std::string& path)
-		: filePath(path), localBuffer(nullptr), width(0), height(0), bitsPerPixel(0)
+	static GLint toGLFilter(TextureFilter filter)
 	{
-		stbi_set_flip_vertically_on_load(1);
-		localBuffer = stbi_load(path.c_str(), &width, &height, &bitsPerPixel, 4);
+		return filter == TextureFilter::NEAREST ? GL_NEAREST : GL_LINEAR;
+	}
 
-		glGenTextures(1, &id);
-		glBindTexture(GL_TEXTURE_2D, id);
+	static GLint toGLMinFilter(TextureFilter filter, TextureFilter mipFilter)
+	{
+		if (filter == TextureFilter::NEAREST)
+			return mipFilter == TextureFilter::NEAREST ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_LINEAR;
+
+		return mipFilter == TextureFilter::NEAREST ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR_MIPMAP_LINEAR;
+	}
+
+	static GLint toGLWrap(TextureWrap wrap)
+	{
+		switch (wrap)
+		{
+			case TextureWrap::REPEAT:			return GL_REPEAT;
+			case TextureWrap::MIRRORED_REPEAT:	return GL_MIRRORED_REPEAT;
+			default:							return GL_CLAMP_TO_EDGE;
+		}
+	}
+
+	static GLenum toGLPixelFormat(int channels)
+	{
+		switch (channels)
+		{
+			case 1:  return GL_RED;
+			case 2:  return GL_RG;
+			case 3:  return GL_RGB;
+			default: return GL_RGBA;
+		}
+	}
+
+	static GLenum toGLInternalFormat(int channels)
+	{
+		switch (channels)
+		{
+			case 1:  return GL_R8;
+			case 2:  return GL_RG8;
+			case 3:  return GL_RGB8;
+			default: return GL_RGBA8;
+		}
+	}
+
+	// Rows of 1 to 3 channels are rarely a multiple of 4 bytes, the default alignment
+	static void setUnpackAlignment(size_t rowSize)
+	{
+		int alignment = rowSize % 8 == 0 ? 8 : rowSize % 4 == 0 ? 4 : rowSize % 2 == 0 ? 2 : 1;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+	}
+
+	static void resetUnpackAlignment()
+	{
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+
+	// 0 when the driver does not support the format
+	static GLenum toGLCompressedFormat(CompressedFormat format, bool srgb)
+	{
+		switch (format)
+		{
+			case CompressedFormat::BC1:
+				if (srgb)
+					return GLExtensions::hasS3TCsRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : 0;
+				return GLExtensions::hasS3TC ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : 0;
+
+			case CompressedFormat::BC3:
+				if (srgb)
+					return GLExtensions::hasS3TCsRGB ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : 0;
+				return GLExtensions::hasS3TC ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+
+			case CompressedFormat::BC7:
+				if (!GLExtensions::hasBPTC)
+					return 0;
+				return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+
+			case CompressedFormat::ETC2_RGB:
+				if (!GLExtensions::hasETC2)
+					return 0;
+				return srgb ? GL_COMPRESSED_SRGB8_ETC2 : GL_COMPRESSED_RGB8_ETC2;
+
+			case CompressedFormat::ETC2_RGBA:
+				if (!GLExtensions::hasETC2)
+					return 0;
+				return srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC : GL_COMPRESSED_RGBA8_ETC2_EAC;
 
-		// Set texture scaling to linear
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			case CompressedFormat::ASTC_4X4:
+				if (!GLExtensions::hasASTC)
+					return 0;
+				return srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR : GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+		}
 
-		// Set wrap
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return 0;
+	}
+
+	Texture::Texture(const std::string& path, const TextureDescriptor& textureDescriptor)
+		: filePath(path), localBuffer(nullptr), width(0), height(0), bitsPerPixel(0), channels(4),
+		  descriptor(textureDescriptor), mipLevels(1)
+	{
+		ProfileScope profile("Texture::load");
+
+		if (isCompressedImageFile(path))
+		{
+			CompressedImage image;
+
+			if (loadCompressedImage(path, image))
+				createCompressed(image);
+			else
+				create(nullptr);
+
+			return;
+		}
+
+		DecodedImage image;
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, localBuffer);
-		glBindTexture(GL_TEXTURE_2D, 0);
+		if (!decodeImage(path, image, 0, descriptor.flipVertically))
+		{
+			std::cout << "Failed to load texture " << path << "!" << std::endl;
+			create(nullptr);
 
-		if (localBuffer)
-			stbi_image_free(localBuffer);
+			return;
+		}
+
+		width = image.width;
+		height = image.height;
+		channels = image.channels;
+		bitsPerPixel = channels * 8;
+
+		localBuffer = image.pixels.get();
+		create(localBuffer);
+		localBuffer = nullptr;
+	}
+
+	Texture::Texture(int textureWidth, int textureHeight, const unsigned char* pixels, const TextureDescriptor& textureDescriptor)
+		: localBuffer(nullptr), width(textureWidth), height(textureHeight), bitsPerPixel(32), channels(4),
+		  descriptor(textureDescriptor), mipLevels(1)
+	{
+		create(pixels);
+	}
+
+	Texture::Texture(int textureWidth, int textureHeight, int pixelChannels, const unsigned char* pixels, const TextureDescriptor& textureDescriptor)
+		: localBuffer(nullptr), width(textureWidth), height(textureHeight), bitsPerPixel(pixelChannels * 8), channels(pixelChannels),
+		  descriptor(textureDescriptor), mipLevels(1)
+	{
+		create(pixels);
+	}
+
+	Texture::Texture(const CompressedImage& image, const std::string& path, const TextureDescriptor& textureDescriptor)
+		: filePath(path), localBuffer(nullptr), width(0), height(0), bitsPerPixel(0), channels(4),
+		  descriptor(textureDescriptor), mipLevels(1)
+	{
+		createCompressed(image);
 	}
 
 	Texture::~Texture()
 	{
-		glDeleteTextures(1, &id);
+		GLStateCache::deleteTexture(id);
 	}
 
 	void Texture::bind(unsigned slot)
 	{
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_2D, id);
+		GLStateCache::bindTexture(slot, GL_TEXTURE_2D, id);
 	}
 
 	void Texture::unbind()
 	{
-		glBindTexture(GL_TEXTURE_2D, 0);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void Texture::setRows(int firstRow, int rowCount, const void* pixels, unsigned int level)
+	{
+		int levelWidth = getMipSize(width, level);
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+
+		setUnpackAlignment((size_t)levelWidth * channels);
+		glTexSubImage2D(GL_TEXTURE_2D, level, 0, firstRow, levelWidth, rowCount, toGLPixelFormat(channels), GL_UNSIGNED_BYTE, pixels);
+		resetUnpackAlignment();
+	}
+
+	void Texture::generateMipmaps()
+	{
+		if (mipLevels < 2)
+			return;
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	void Texture::setMipChain(const void* chain)
+	{
+		GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+
+		// Pointer arithmetic also works for an offset into a pixel unpack buffer
+		const unsigned char* level = (const unsigned char*)chain;
+
+		for (unsigned int i = 1; i < mipLevels; i++)
+		{
+			int levelWidth = getMipSize(width, i);
+
+			setUnpackAlignment((size_t)levelWidth * channels);
+			glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, levelWidth, getMipSize(height, i), toGLPixelFormat(channels), GL_UNSIGNED_BYTE, level);
+
+			level += getMipByteSize(width, height, i, channels);
+		}
+
+		resetUnpackAlignment();
+	}
+
+	void Texture::create(const unsigned char* pixels)
+	{
+		ProfileScope profile("Texture::upload");
+
+		// Failed loads get one magenta pixel, storage of size 0 is an error
+		static const unsigned char MISSING_PIXEL[] = { 255, 0, 255, 255 };
+
+		if (width <= 0 || height <= 0)
+		{
+			width = 1;
+			height = 1;
+			channels = 4;
+			bitsPerPixel = 32;
+			pixels = MISSING_PIXEL;
+		}
+
+		mipLevels = descriptor.mipmaps != MipmapMode::NONE ? getMipLevelCount(width, height) : 1;
+
+		glGenTextures(1, &id);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+
+		applyTextureSampling(GL_TEXTURE_2D, descriptor, mipLevels);
+
+		// Grey images sample like the RGBA8 expansion they replace
+		if (channels == 1)
+		{
+			GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+		else if (channels == 2)
+		{
+			GLint swizzle[] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+			glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+		}
+
+		GLenum internalFormat = toGLInternalFormat(channels);
+		GLenum pixelFormat = toGLPixelFormat(channels);
+
+		setUnpackAlignment((size_t)width * channels);
+
+		if (GLExtensions::hasTextureStorage)
+		{
+			// Every level allocated at once, the driver never has to check the texture is complete
+			GLExtensions::texStorage2D(GL_TEXTURE_2D, mipLevels, internalFormat, width, height);
+
+			if (pixels)
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, pixelFormat, GL_UNSIGNED_BYTE, pixels);
+		}
+		else
+		{
+			for (unsigned int level = 0; level < mipLevels; level++)
+			{
+				glTexImage2D(GL_TEXTURE_2D, level, internalFormat, getMipSize(width, level), getMipSize(height, level), 0,
+					pixelFormat, GL_UNSIGNED_BYTE, level == 0 ? pixels : nullptr);
+			}
+		}
+
+		resetUnpackAlignment();
+
+		// Levels past the allocated ones would leave the texture incomplete
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+
+		if (pixels && descriptor.mipmaps == MipmapMode::GPU)
+		{
+			glGenerateMipmap(GL_TEXTURE_2D);
+		}
+		else if (pixels && descriptor.mipmaps == MipmapMode::CPU)
+		{
+			std::vector<unsigned char> chain = buildMipChain(pixels, width, height, mipLevels, channels);
+			setMipChain(chain.data());
+		}
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void Texture::createCompressed(const CompressedImage& image)
+	{
+		ProfileScope profile("Texture::upload");
+
+		width = image.width;
+		height = image.height;
+		bitsPerPixel = (int)getBlockSize(image.format) / 2;
+		mipLevels = (unsigned int)image.levels.size();
+
+		// Blocks are uploaded as stored, rows can not be flipped here
+		if (image.bottomUp != descriptor.flipVertically)
+		{
+			std::cout << "Warning: " << filePath << " is stored " << (image.bottomUp ? "bottom" : "top")
+				<< " row first, it shows upside down with flipVertically " << (descriptor.flipVertically ? "on" : "off") << "!" << std::endl;
+		}
+
+		GLenum internalFormat = toGLCompressedFormat(image.format, image.srgb);
+
+		// Decode on the CPU, it costs the memory the format was meant to save
+		std::vector<std::vector<unsigned char>> decoded;
+
+		if (internalFormat == 0)
+		{
+			decoded.resize(mipLevels);
+
+			for (unsigned int level = 0; level < mipLevels; level++)
+			{
+				const CompressedLevel& source = image.levels[level];
+
+				if (!decompressImage(image.getLevelData(level), source.width, source.height, image.format, decoded[level]))
+				{
+					std::cout << getFormatName(image.format) << " textures are not supported by the driver, could not load " << filePath << "!" << std::endl;
+
+					// Falls back to the missing texture
+					width = 0;
+					height = 0;
+					create(nullptr);
+
+					return;
+				}
+			}
+
+			std::cout << getFormatName(image.format) << " textures are not supported by the driver, decoded " << filePath << std::endl;
+		}
+
+		glGenTextures(1, &id);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, id);
+
+		applyTextureSampling(GL_TEXTURE_2D, descriptor, mipLevels);
+
+		GLenum storageFormat = internalFormat ? internalFormat : image.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+		if (GLExtensions::hasTextureStorage)
+			GLExtensions::texStorage2D(GL_TEXTURE_2D, mipLevels, storageFormat, width, height);
+
+		for (unsigned int level = 0; level < mipLevels; level++)
+		{
+			const CompressedLevel& source = image.levels[level];
+
+			if (!decoded.empty())
+			{
+				if (GLExtensions::hasTextureStorage)
+				{
+					glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, source.width, source.height,
+						GL_RGBA, GL_UNSIGNED_BYTE, decoded[level].data());
+				}
+				else
+				{
+					glTexImage2D(GL_TEXTURE_2D, level, storageFormat, source.width, source.height, 0,
+						GL_RGBA, GL_UNSIGNED_BYTE, decoded[level].data());
+				}
+			}
+			else if (GLExtensions::hasTextureStorage)
+			{
+				glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, source.width, source.height, internalFormat,
+					(GLsizei)source.size, image.getLevelData(level));
+			}
+			else
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, source.width, source.height, 0,
+					(GLsizei)source.size, image.getLevelData(level));
+			}
+		}
+
+		// Levels past the ones in the file would leave the texture incomplete
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+		GLStateCache::bindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	void applyTextureSampling(unsigned int target, const TextureDescriptor& descriptor, unsigned int mipLevels)
+	{
+		GLint minFilter = mipLevels > 1 ? toGLMinFilter(descriptor.minFilter, descriptor.mipFilter) : toGLFilter(descriptor.minFilter);
+
+		glTexParameteri(target, GL_TEXTURE_MIN_FILTER, minFilter);
+		glTexParameteri(target, GL_TEXTURE_MAG_FILTER, toGLFilter(descriptor.magFilter));
+
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, toGLWrap(descriptor.wrapS));
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, toGLWrap(descriptor.wrapT));
+
+		if (GLExtensions::hasAnisotropicFiltering && descriptor.anisotropy > 1.0f)
+		{
+			float anisotropy = descriptor.anisotropy < GLExtensions::maxAnisotropy ? descriptor.anisotropy : GLExtensions::maxAnisotropy;
+			glTexParameterf(target, GL_TEXTURE_MAX_ANISOTROPY, anisotropy);
+		}
 	}
 }
\ No newline at end of file
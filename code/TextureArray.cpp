@@ -0,0 +1,105 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "TextureArray.h"
+#include "ImageDecoder.h"
+#include "GLStateCache.h"
+#include "GLExtensions.h"
+#include "Mipmap.h"
+
+namespace mg
+{
+	TextureArray::TextureArray(int layerWidth, int layerHeight, unsigned int layers, const TextureDescriptor& textureDescriptor)
+		: width(layerWidth), height(layerHeight), layerCount(layers), descriptor(textureDescriptor), mipLevels(1)
+	{
+		mipLevels = descriptor.mipmaps != MipmapMode::NONE ? getMipLevelCount(width, height) : 1;
+
+		glGenTextures(1, &id);
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+		applyTextureSampling(GL_TEXTURE_2D_ARRAY, descriptor, mipLevels);
+
+		if (GLExtensions::hasTextureStorage)
+		{
+			GLExtensions::texStorage3D(GL_TEXTURE_2D_ARRAY, mipLevels, GL_RGBA8, width, height, layerCount);
+		}
+		else
+		{
+			for (unsigned int level = 0; level < mipLevels; level++)
+			{
+				glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, getMipSize(width, level), getMipSize(height, level), layerCount, 0,
+					GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			}
+		}
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	TextureArray::~TextureArray()
+	{
+		GLStateCache::deleteTexture(id);
+	}
+
+	void TextureArray::bind(unsigned slot)
+	{
+		GLStateCache::bindTexture(slot, GL_TEXTURE_2D_ARRAY, id);
+	}
+
+	void TextureArray::unbind()
+	{
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	void TextureArray::setLayer(unsigned int layer, const unsigned char* pixels)
+	{
+		if (layer >= layerCount)
+			return;
+
+		GLStateCache::bindTexture(GL_TEXTURE_2D_ARRAY, id);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+		if (mipLevels < 2)
+			return;
+
+		// glGenerateMipmap would filter every layer again, CPU filtering touches only this one
+		std::vector<unsigned char> chain = buildMipChain(pixels, width, height, mipLevels);
+		const unsigned char* level = chain.data();
+
+		for (unsigned int i = 1; i < mipLevels; i++)
+		{
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, i, 0, 0, layer, getMipSize(width, i), getMipSize(height, i), 1,
+				GL_RGBA, GL_UNSIGNED_BYTE, level);
+
+			level += getMipByteSize(width, height, i);
+		}
+	}
+
+	bool TextureArray::loadLayer(unsigned int layer, const std::string& path)
+	{
+		DecodedImage image;
+
+		if (!decodeImage(path, image, 4, descriptor.flipVertically))
+		{
+			std::cout << "Failed to load " << path << "!" << std::endl;
+			return false;
+		}
+
+		if (image.width != width || image.height != height)
+		{
+			std::cout << path << " is " << image.width << "x" << image.height << ", layers of the array are " << width << "x" << height << "!" << std::endl;
+			return false;
+		}
+
+		setLayer(layer, image.pixels.get());
+
+		return true;
+	}
+}
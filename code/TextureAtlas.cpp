@@ -0,0 +1,85 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <cstring>
+#include <iostream>
+
+#include "TextureAtlas.h"
+
+namespace mg
+{
+	static uint32_t hashName(const std::string& name)
+	{
+		return fnv1a32(name.data(), name.size());
+	}
+
+	TextureAtlas::TextureAtlas(const AtlasLayout& layout, const TextureDescriptor& descriptor)
+		: texture(std::make_unique<Texture>(layout.width, layout.height, layout.pixels.data(), descriptor)),
+		  names(layout.names), regions(layout.regions)
+	{
+		indexRegions();
+	}
+
+	TextureAtlas::TextureAtlas(const std::string& imagePath, const std::string& tablePath, const TextureDescriptor& descriptor)
+		: texture(std::make_unique<Texture>(imagePath, descriptor))
+	{
+		AtlasLayout layout;
+
+		if (loadAtlasTable(tablePath, layout))
+		{
+			if (layout.width != texture->getWidth() || layout.height != texture->getHeight())
+				std::cout << "Atlas table " << tablePath << " does not match the size of " << imagePath << "!" << std::endl;
+
+			names = std::move(layout.names);
+			regions = std::move(layout.regions);
+		}
+
+		indexRegions();
+	}
+
+	const AtlasRegion* TextureAtlas::find(const std::string& name) const
+	{
+		// Names are compared too, a missing name may hash like one in the atlas
+		auto range = regionIndices.equal_range(hashName(name));
+
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (names[it->second] == name)
+				return &regions[it->second];
+		}
+
+		return nullptr;
+	}
+
+	void TextureAtlas::indexRegions()
+	{
+		regionIndices.clear();
+
+		for (size_t i = 0; i < names.size(); i++)
+		{
+			if (find(names[i]))
+			{
+				std::cout << "Atlas image " << names[i] << " is in the atlas twice, only the first one can be found!" << std::endl;
+				continue;
+			}
+
+			regionIndices.emplace(hashName(names[i]), i);
+		}
+	}
+
+	void remapTexCoords(void* vertices, unsigned int vertexCount, unsigned int stride, unsigned int texCoordOffset, const AtlasRegion& region)
+	{
+		unsigned char* vertex = (unsigned char*)vertices + texCoordOffset;
+
+		for (unsigned int i = 0; i < vertexCount; i++, vertex += stride)
+		{
+			glm::vec2 texCoord;
+			memcpy(&texCoord, vertex, sizeof(texCoord));
+
+			texCoord = region.remap(texCoord);
+			memcpy(vertex, &texCoord, sizeof(texCoord));
+		}
+	}
+}
@@ -0,0 +1,284 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "TextureLoader.h"
+#include "Mipmap.h"
+#include "Profiler.h"
+
+namespace mg
+{
+	// 2x2 grey checker shown while loading
+	static const unsigned char PLACEHOLDER_PIXELS[] =
+	{
+		 96,  96,  96, 255,   160, 160, 160, 255,
+		160, 160, 160, 255,    96,  96,  96, 255
+	};
+
+	TextureLoader::TextureLoader(size_t bytesPerFrame, unsigned int threadCount)
+		: placeholder(2, 2, PLACEHOLDER_PIXELS), uploadBuffer(GL_PIXEL_UNPACK_BUFFER, bytesPerFrame),
+		  uploadBudget(bytesPerFrame), maxDecoded(0), stopping(false)
+	{
+		if (threadCount == 0)
+		{
+			unsigned int cores = std::thread::hardware_concurrency();
+			threadCount = cores > 1 ? cores - 1 : 1;
+		}
+
+		// Enough to keep uploads busy while workers decode the next ones
+		maxDecoded = threadCount * 2;
+
+		for (unsigned int i = 0; i < threadCount; i++)
+			workers.emplace_back(&TextureLoader::work, this);
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		jobAvailable.notify_all();
+		imageTaken.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	TextureHandle TextureLoader::load(const std::string& path, const TextureDescriptor& descriptor)
+	{
+		int slot = (int)entries.size();
+		entries.push_back({ path, descriptor, TextureLoadState::DECODING, nullptr });
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			jobs.push_back({ slot, path, descriptor.mipmaps, descriptor.flipVertically });
+		}
+
+		jobAvailable.notify_one();
+
+		return TextureHandle(slot);
+	}
+
+	void TextureLoader::update()
+	{
+		ProfileScope profile("TextureLoader::update");
+
+		size_t budget = uploadBudget;
+
+		while (budget > 0)
+		{
+			Image* image;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (decoded.empty())
+					break;
+
+				// Workers only push at the back, the front stays valid unlocked
+				image = &decoded.front();
+			}
+
+			Entry& entry = entries[image->slot];
+
+			if (!image->pixels.pixels && !image->compressed)
+			{
+				std::cout << "Failed to load texture " << entry.path << "!" << std::endl;
+				entry.state = TextureLoadState::FAILED;
+			}
+			else if (image->compressed)
+			{
+				size_t size = image->compressed->data.size();
+
+				// Wait for a frame with enough budget left
+				if (size > budget && budget < uploadBudget)
+					break;
+
+				uploadBuffer.unbind();
+
+				entry.texture = std::make_unique<Texture>(*image->compressed, entry.path, entry.descriptor);
+				entry.state = TextureLoadState::LOADED;
+
+				budget -= std::min(size, budget);
+			}
+			else
+			{
+				const DecodedImage& pixels = image->pixels;
+
+				if (!entry.texture)
+				{
+					// A null pointer with the buffer bound would read its first bytes
+					uploadBuffer.unbind();
+
+					entry.texture = std::make_unique<Texture>(pixels.width, pixels.height, pixels.channels, nullptr, entry.descriptor);
+					entry.state = TextureLoadState::UPLOADING;
+				}
+
+				if (image->uploadedRows < pixels.height)
+				{
+					size_t rowSize = (size_t)pixels.width * pixels.channels;
+					int remainingRows = pixels.height - image->uploadedRows;
+					int rows = (int)std::min<size_t>(remainingRows, budget / rowSize);
+
+					// Budget is spent for this frame
+					if (rows == 0 && budget < uploadBudget)
+						break;
+
+					const unsigned char* source = pixels.pixels.get() + image->uploadedRows * rowSize;
+
+					if (rows > 0)
+					{
+						size_t available;
+						void* destination = uploadBuffer.map(rows * rowSize, 4, available);
+						memcpy(destination, source, rows * rowSize);
+
+						size_t offset = uploadBuffer.unmap(rows * rowSize);
+
+						// Texture reads from the bound pixel unpack buffer
+						uploadBuffer.bind();
+						entry.texture->setRows(image->uploadedRows, rows, (const void*)offset);
+
+						budget -= rows * rowSize;
+					}
+					// A single row wider than the whole budget, upload it straight from memory
+					else
+					{
+						rows = 1;
+						uploadBuffer.unbind();
+						entry.texture->setRows(image->uploadedRows, rows, source);
+
+						budget = 0;
+					}
+
+					image->uploadedRows += rows;
+
+					if (image->uploadedRows < pixels.height)
+						continue;
+				}
+
+				// Level 0 is complete, fill the rest of the chain
+				if (!image->mipChain.empty())
+				{
+					size_t chainSize = image->mipChain.size();
+
+					if (chainSize <= budget)
+					{
+						size_t available;
+						void* destination = uploadBuffer.map(chainSize, 4, available);
+						memcpy(destination, image->mipChain.data(), chainSize);
+
+						size_t offset = uploadBuffer.unmap(chainSize);
+
+						uploadBuffer.bind();
+						entry.texture->setMipChain((const void*)offset);
+
+						budget -= chainSize;
+					}
+					// Wait for a frame with enough budget left
+					else if (budget < uploadBudget)
+					{
+						break;
+					}
+					else
+					{
+						uploadBuffer.unbind();
+						entry.texture->setMipChain(image->mipChain.data());
+
+						budget = 0;
+					}
+				}
+				else if (entry.descriptor.mipmaps == MipmapMode::GPU)
+				{
+					entry.texture->generateMipmaps();
+				}
+
+				entry.state = TextureLoadState::LOADED;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				decoded.pop_front();
+			}
+
+			imageTaken.notify_one();
+		}
+
+		// Later uploads from client memory must not read from the buffer
+		uploadBuffer.unbind();
+		uploadBuffer.endFrame();
+	}
+
+	Texture& TextureLoader::get(TextureHandle handle)
+	{
+		if (!handle.isValid() || entries[handle.slot].state != TextureLoadState::LOADED)
+			return placeholder;
+
+		return *entries[handle.slot].texture;
+	}
+
+	size_t TextureLoader::getPendingCount() const
+	{
+		return std::count_if(entries.begin(), entries.end(), [](const Entry& entry)
+		{
+			return entry.state == TextureLoadState::DECODING || entry.state == TextureLoadState::UPLOADING;
+		});
+	}
+
+	void TextureLoader::work()
+	{
+		Profiler::setThreadName("Texture loader");
+
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+				if (stopping)
+					return;
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			// Failures are queued too, with null pixels, so the render thread learns about them
+			Image image = { job.slot, {}, 0, {}, nullptr };
+
+			{
+				ProfileScope profile("TextureLoader::decode");
+
+				if (isCompressedImageFile(job.path))
+				{
+					image.compressed = std::make_unique<CompressedImage>();
+
+					if (!loadCompressedImage(job.path, *image.compressed))
+						image.compressed.reset();
+				}
+				else if (decodeImage(job.path, image.pixels, 0, job.flipped) && job.mipmaps == MipmapMode::CPU)
+				{
+					const DecodedImage& pixels = image.pixels;
+					image.mipChain = buildMipChain(pixels.pixels.get(), pixels.width, pixels.height, getMipLevelCount(pixels.width, pixels.height), pixels.channels);
+				}
+			}
+
+			std::unique_lock<std::mutex> lock(mutex);
+			imageTaken.wait(lock, [this] { return stopping || decoded.size() < maxDecoded; });
+
+			if (stopping)
+				return;
+
+			decoded.push_back(std::move(image));
+		}
+	}
+}
@@ -0,0 +1,63 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "UniformBuffer.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
+
+namespace mg
+{
+	std::vector<UniformBuffer::BlockBinding> UniformBuffer::registeredBlocks;
+
+	UniformBuffer::UniformBuffer(const std::string& name, size_t blockSize, unsigned int bindingPoint)
+		: binding(bindingPoint), size(blockSize), blockName(name)
+	{
+		glGenBuffers(1, &id);
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, id);
+		glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+
+		GLStateCache::bindBufferBase(GL_UNIFORM_BUFFER, binding, id);
+
+		registeredBlocks.push_back({ blockName, binding });
+	}
+
+	UniformBuffer::~UniformBuffer()
+	{
+		auto it = std::find_if(registeredBlocks.begin(), registeredBlocks.end(),
+			[this](const BlockBinding& block) { return block.name == blockName && block.binding == binding; });
+
+		if (it != registeredBlocks.end())
+			registeredBlocks.erase(it);
+
+		GLStateCache::deleteBuffer(id);
+	}
+
+	void UniformBuffer::setData(const void* data, size_t dataSize, size_t offset)
+	{
+		assert(offset + dataSize <= size);
+
+		GLStateCache::bindBuffer(GL_UNIFORM_BUFFER, id);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, dataSize, data);
+
+		RenderStats::countUniformUpload();
+		RenderStats::countBufferUpload(dataSize);
+	}
+
+	void UniformBuffer::bindBlocks(unsigned int program)
+	{
+		for (const BlockBinding& block : registeredBlocks)
+		{
+			unsigned int index = glGetUniformBlockIndex(program, block.name.c_str());
+
+			if (index != GL_INVALID_INDEX)
+				glUniformBlockBinding(program, index, block.binding);
+		}
+	}
+}
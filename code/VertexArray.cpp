@@ -5,17 +5,19 @@
 
 #include "VertexArray.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
 
 namespace mg
 {
 	VertexArray::VertexArray()
+		: attributeCount(0)
 	{
 		glGenVertexArrays(1, &id);
 	}
 
 	VertexArray::~VertexArray()
 	{
-		glDeleteVertexArrays(1, &id);
+		GLStateCache::deleteVertexArray(id);
 	}
 
 	void VertexArray::addBuffer(VertexBuffer& vb, const VertexBufferLayout& layout)
@@ -23,28 +25,50 @@ namespace mg
 		bind();
 		vb.bind();
 
-		const auto elements = layout.getElements();
+		addAttributes(layout);
+	}
+
+	void VertexArray::addBuffer(StreamingBuffer& sb, const VertexBufferLayout& layout)
+	{
+		bind();
+		GLStateCache::bindBuffer(GL_ARRAY_BUFFER, sb.getId());
+
+		addAttributes(layout);
+	}
+
+	void VertexArray::addAttributes(const VertexBufferLayout& layout)
+	{
+		const auto& elements = layout.getElements();
 		unsigned int offset = 0;
 
 		// Add each element to the vertex array object
 		for (unsigned int i = 0; i < elements.size(); i++)
 		{
 			const auto& element = elements[i];
+			const unsigned int typeSize = VertexBufferElement::GetSizeOfType(element.type);
+
+			// Attributes hold up to 4 components, wider elements use consecutive locations
+			for (unsigned int component = 0; component < element.count; component += 4)
+			{
+				unsigned int location = attributeCount++;
+				unsigned int count = element.count - component < 4 ? element.count - component : 4;
 
-			glEnableVertexAttribArray(i);
-			glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.getStride(), (const void*)offset);
+				glEnableVertexAttribArray(location);
+				glVertexAttribPointer(location, count, element.type, element.normalized, layout.getStride(), (const void*)(size_t)offset);
+				glVertexAttribDivisor(location, element.divisor);
 
-			offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+				offset += count * typeSize;
+			}
 		}
 	}
 
 	void VertexArray::bind()
 	{
-		glBindVertexArray(id);
+		GLStateCache::bindVertexArray(id);
 	}
 
 	void VertexArray::unbind()
 	{
-		glBindVertexArray(0);
+		GLStateCache::bindVertexArray(0);
 	}
 }
\ No newline at end of file
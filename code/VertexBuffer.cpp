@@ -3,30 +3,62 @@
 // @miguelgutierrezruano
 // 2023
 
+#include <cassert>
+
 #include "VertexBuffer.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "RenderStats.h"
 
 namespace mg
 {
 	VertexBuffer::VertexBuffer(const void* data, size_t size)
+		: size(size)
 	{
 		glGenBuffers(1, &id);
-		glBindBuffer(GL_ARRAY_BUFFER, id);
+		GLStateCache::bindBuffer(GL_ARRAY_BUFFER, id);
 		glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+
+		if (data)
+			RenderStats::countBufferUpload(size);
+	}
+
+	VertexBuffer::VertexBuffer(size_t size)
+		: size(size)
+	{
+		glGenBuffers(1, &id);
+		GLStateCache::bindBuffer(GL_ARRAY_BUFFER, id);
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
 	}
 
 	VertexBuffer::~VertexBuffer()
 	{
-		glDeleteBuffers(1, &id);
+		GLStateCache::deleteBuffer(id);
 	}
 
 	void VertexBuffer::bind()
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, id);
+		GLStateCache::bindBuffer(GL_ARRAY_BUFFER, id);
 	}
 
 	void VertexBuffer::unbind()
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		GLStateCache::bindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void VertexBuffer::setData(const void* data, size_t dataSize, size_t offset)
+	{
+		assert(offset + dataSize <= size);
+
+		bind();
+		glBufferSubData(GL_ARRAY_BUFFER, offset, dataSize, data);
+
+		RenderStats::countBufferUpload(dataSize);
+	}
+
+	void VertexBuffer::orphan()
+	{
+		bind();
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
 	}
-}
\ No newline at end of file
+}
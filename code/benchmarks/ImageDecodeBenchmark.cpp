@@ -0,0 +1,92 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+// Compares decoding a texture the way Texture used to, forced to RGBA
+// and flipped by stb_image, against decodeImage keeping the channels of
+// the file and flipping rows in place with SIMD
+//
+// Usage: ImageDecodeBenchmark [image] [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "other/stb_image.h"
+#include "ImageDecoder.h"
+
+using namespace std::chrono;
+
+// Decode used by Texture before decodeImage, kept for reference
+static size_t decodeLegacy(const std::string& path)
+{
+    // Per thread, decodeImage sets the thread flag and that one wins over the global one
+    stbi_set_flip_vertically_on_load_thread(1);
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(path.c_str(), &width, &height, &channels, 4);
+
+    if (!pixels)
+        return 0;
+
+    stbi_image_free(pixels);
+
+    // Bytes handed to glTexImage2D
+    return (size_t)width * height * 4;
+}
+
+static size_t decodeNative(const std::string& path)
+{
+    stbi_set_flip_vertically_on_load_thread(0);
+
+    mg::DecodedImage image;
+
+    if (!mg::decodeImage(path, image, 0, true))
+        return 0;
+
+    return (size_t)image.width * image.height * image.channels;
+}
+
+template<typename Decode>
+static double measure(Decode decode, const std::string& path, size_t& uploadSize)
+{
+    auto start = steady_clock::now();
+    uploadSize = decode(path);
+
+    return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    std::string path = argc > 1 ? argv[1] : "../resources/textures/ciri.jpg";
+    int iterations   = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    size_t legacySize = 0;
+    size_t nativeSize = 0;
+
+    // Warm file cache
+    if (decodeNative(path) == 0)
+    {
+        std::cout << "Failed to load " << path << "!" << std::endl;
+        return 1;
+    }
+
+    double legacy = 0.0;
+    double native = 0.0;
+
+    // Interleaved so both see the same machine load
+    for (int i = 0; i < iterations; i++)
+    {
+        legacy += measure(decodeLegacy, path, legacySize) / iterations;
+        native += measure(decodeNative, path, nativeSize) / iterations;
+    }
+
+    std::cout << path << ", iterations: " << iterations << std::endl;
+    std::cout << "RGBA + stb flip:        " << legacy << " ms, " << legacySize << " bytes to upload" << std::endl;
+    std::cout << "native + SIMD flip:     " << native << " ms, " << nativeSize << " bytes to upload" << std::endl;
+    std::cout << "speedup:                " << legacy / native << "x" << std::endl;
+
+    return 0;
+}
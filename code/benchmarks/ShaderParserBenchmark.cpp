@@ -0,0 +1,129 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+// Compares loading a .shader file the way Shader does, preprocessing it
+// and splitting the stages in a single pass, against the previous
+// getline + stringstream parser on generated files
+//
+// Usage: ShaderParserBenchmark [lines per stage] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "ShaderParser.h"
+#include "ShaderPreprocessor.h"
+
+using namespace std::chrono;
+
+// Parser used by Shader before the single pass one, kept for reference
+static size_t parseLegacy(const std::string& path)
+{
+    std::ifstream stream(path);
+
+    enum class ShaderType
+    {
+        NONE = -1, VERTEX = 0, FRAGMENT = 1
+    };
+
+    std::stringstream ss[2];
+    ShaderType type = ShaderType::NONE;
+
+    std::string line;
+    while (getline(stream, line))
+    {
+        if (line.find("#shader") != std::string::npos)
+        {
+            if (line.find("vertex") != std::string::npos)
+                type = ShaderType::VERTEX;
+            else if (line.find("fragment") != std::string::npos)
+                type = ShaderType::FRAGMENT;
+        }
+        else
+        {
+            if (type != ShaderType::NONE)
+                ss[(int)type] << line << '\n';
+        }
+    }
+
+    return ss[0].str().size() + ss[1].str().size();
+}
+
+static size_t parseSinglePass(const std::string& path)
+{
+    // New preprocessor every time, the file is read from disk like the legacy parser does
+    mg::ShaderPreprocessor preprocessor;
+    std::string text = preprocessor.process(path);
+
+    mg::ShaderSourceView stages = mg::splitShaderSource(text);
+
+    return stages.vertexSource.size() + stages.fragmentSource.size();
+}
+
+static void writeShader(const std::string& path, int linesPerStage)
+{
+    std::ofstream stream(path);
+
+    const char* stages[] = { "vertex", "fragment" };
+
+    for (const char* stage : stages)
+    {
+        stream << "#shader " << stage << "\n#version 330 core\n\n";
+
+        for (int i = 0; i < linesPerStage; i++)
+            stream << "    vec4 value" << i << " = texture(u_Texture, v_TexCoord + vec2(" << i << ".0)) * u_Color;\n";
+
+        stream << "\nvoid main()\n{\n}\n\n";
+    }
+}
+
+template<typename Parse>
+static double measure(Parse parse, const std::string& path, int iterations, size_t& checksum)
+{
+    auto start = steady_clock::now();
+
+    for (int i = 0; i < iterations; i++)
+        checksum += parse(path);
+
+    return duration<double, std::milli>(steady_clock::now() - start).count() / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    int linesPerStage = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int iterations    = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    const std::string path = "ShaderParserBenchmark.shader";
+    writeShader(path, linesPerStage);
+
+    size_t legacyChecksum = 0;
+    size_t singlePassChecksum = 0;
+
+    // Warm file cache
+    parseSinglePass(path);
+
+    double legacy = measure(parseLegacy, path, iterations, legacyChecksum);
+    double singlePass = measure(parseSinglePass, path, iterations, singlePassChecksum);
+
+    std::remove(path.c_str());
+
+    std::cout << "Lines per stage: " << linesPerStage << ", iterations: " << iterations << std::endl;
+    std::cout << "getline + stringstream: " << legacy << " ms" << std::endl;
+    std::cout << "single pass:            " << singlePass << " ms" << std::endl;
+    std::cout << "speedup:                " << legacy / singlePass << "x" << std::endl;
+
+    // Both parsers must see the same stages
+    if (legacyChecksum != singlePassChecksum)
+    {
+        std::cout << "Mismatch between parsers!" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
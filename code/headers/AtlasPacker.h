@@ -0,0 +1,147 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace mg
+{
+	// Packs rectangles into a fixed size bin by keeping the skyline, the
+	// top edge of everything placed so far, as a list of horizontal
+	// segments
+	//
+	// Each rectangle goes where its top ends lowest, ties are broken by
+	// the area it would leave unusable below it
+	class SkylinePacker
+	{
+
+	private:
+
+		struct Segment
+		{
+			int x;
+			int y;
+			int width;
+		};
+
+		int width;
+		int height;
+
+		std::vector<Segment> skyline;
+
+		long long usedArea;
+
+	public:
+
+		SkylinePacker(int binWidth, int binHeight);
+
+		// Bottom left corner of the rectangle, false if it does not fit
+		bool insert(int rectWidth, int rectHeight, int& x, int& y);
+
+		void reset(int binWidth, int binHeight);
+
+		// Fraction of the bin covered by rectangles
+		float getOccupancy() const { return (float)usedArea / ((long long)width * height); }
+
+		int getWidth () const { return  width; }
+		int getHeight() const { return height; }
+
+	private:
+
+		// Top of a rectangle placed at segment index, -1 if it does not fit
+		int fit(size_t index, int rectWidth, int rectHeight, int& wastedArea) const;
+
+		void addSegment(size_t index, int x, int y, int rectWidth, int rectHeight);
+	};
+
+	// Place of one source image inside an atlas
+	struct AtlasRegion
+	{
+		// Texels, origin at the bottom left like texture coordinates
+		int x;
+		int y;
+		int width;
+		int height;
+
+		// (u0, v0, u1, v1), as taken by SpriteBatch::draw
+		glm::vec4 uvRect;
+
+		// Texture coordinate of the source image to one of the atlas
+		glm::vec2 remap(glm::vec2 uv) const
+		{
+			return glm::vec2(uvRect.x + (uvRect.z - uvRect.x) * uv.x, uvRect.y + (uvRect.w - uvRect.y) * uv.y);
+		}
+	};
+
+	struct AtlasSettings
+	{
+		// Largest side tried, the atlas is the smallest power of two size
+		// that holds every image
+		int maxSize = 4096;
+
+		// Texels around every image filled with its edge texels, so
+		// bilinear filtering never reads a neighbour
+		int padding = 2;
+
+		// Images and their cells start at multiples of it, the gutter before
+		// an image is padding rounded up to it, so with an alignment of 4
+		// no 4x4 block of a compressed format holds two images and their
+		// borders stay apart at the first log2(alignment) mip levels
+		int alignment = 4;
+	};
+
+	// RGBA8 atlas with its regions, last row first like Texture expects
+	struct AtlasLayout
+	{
+		int width = 0;
+		int height = 0;
+
+		std::vector<unsigned char> pixels;
+
+		// Same order as the images were added
+		std::vector<std::string> names;
+		std::vector<AtlasRegion> regions;
+	};
+
+	// Packs images into an atlas with a skyline packer, needs no context
+	// so it runs offline in TextureTool as well as at runtime
+	class AtlasBuilder
+	{
+
+	private:
+
+		struct Source
+		{
+			std::string name;
+			int width;
+			int height;
+			std::vector<unsigned char> pixels;
+		};
+
+		std::vector<Source> sources;
+
+	public:
+
+		// RGBA8 pixels, last row first
+		void add(const std::string& name, const unsigned char* pixels, int width, int height);
+
+		// Decode a file flipped like Texture does, false if it fails
+		bool addFile(const std::string& name, const std::string& path);
+
+		// Larger images are placed first, false if they do not fit in
+		// settings.maxSize
+		bool build(const AtlasSettings& settings, AtlasLayout& layout) const;
+
+		size_t getImageCount() const { return sources.size(); }
+	};
+
+	// Text table of regions written next to an atlas image, the pixels
+	// of the layout are not part of it
+	bool saveAtlasTable(const std::string& path, const AtlasLayout& layout);
+	bool loadAtlasTable(const std::string& path, AtlasLayout& layout);
+}
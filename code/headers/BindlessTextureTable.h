@@ -0,0 +1,83 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "UniformBuffer.h"
+
+namespace mg
+{
+	class Texture;
+
+	// Resident bindless handles of textures in the BindlessTextures uniform
+	// block of BindlessTextures.glsl, shaders sample any texture of the
+	// table by its index without a bind in between
+	//
+	// Needs ARB_bindless_texture, check GLExtensions::hasBindlessTexture
+	// Once a texture has a handle its sampling parameters can not change,
+	// and it must be removed from the table before it is destroyed
+	class BindlessTextureTable
+	{
+
+	public:
+
+		// 8 KB of handles, half the smallest uniform block size allowed
+		static const unsigned int DEFAULT_CAPACITY = 1024;
+
+		static const unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+	private:
+
+		// Two handles per uvec4 of the std140 block, so it is a tight array
+		std::vector<uint64_t> handles;
+
+		// Texture id to index in handles
+		std::unordered_map<unsigned int, unsigned int> indices;
+		std::vector<unsigned int> freeIndices;
+
+		UniformBuffer buffer;
+
+		// Range of handles changed since the last upload
+		unsigned int dirtyBegin;
+		unsigned int dirtyEnd;
+
+	public:
+
+		// Capacity must match the array size declared in BindlessTextures.glsl
+		BindlessTextureTable(unsigned int bindingPoint, unsigned int capacity = DEFAULT_CAPACITY);
+	   ~BindlessTextureTable();
+
+		BindlessTextureTable(const BindlessTextureTable&) = delete;
+		BindlessTextureTable& operator=(const BindlessTextureTable&) = delete;
+
+	public:
+
+		// Index of the texture in the table, its handle is made resident the
+		// first time, INVALID_INDEX when the table is full
+		unsigned int add(const Texture& texture);
+
+		// Make the handle non resident and free its index
+		//
+		// Sampling a removed or non resident handle is undefined and can
+		// crash the driver, no draw may use the index after this call, and
+		// the index may be given to another texture by a later add
+		void remove(const Texture& texture);
+
+		// Upload handles added or removed since the last call, once per frame
+		// before drawing
+		void update();
+
+		unsigned int getCount() const { return (unsigned int)indices.size(); }
+		unsigned int getCapacity() const { return (unsigned int)handles.size(); }
+
+	private:
+
+		void markDirty(unsigned int index);
+	};
+}
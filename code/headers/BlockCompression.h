@@ -0,0 +1,54 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace mg
+{
+	// Block compressed formats, every one of them stores 4x4 texel blocks
+	enum class CompressedFormat
+	{
+		// RGB with 1 bit alpha, 8 bytes per block
+		BC1,
+		// RGB of BC1 with interpolated alpha, 16 bytes per block
+		BC3,
+		// RGBA with better endpoints, 16 bytes per block
+		BC7,
+		// Loaded from containers only, there is no encoder for them
+		ETC2_RGB,
+		ETC2_RGBA,
+		ASTC_4X4
+	};
+
+	// Bytes of one 4x4 block
+	size_t getBlockSize(CompressedFormat format);
+
+	// Bytes of an image, partial blocks at the edges count as full ones
+	size_t getCompressedSize(CompressedFormat format, int width, int height);
+
+	const char* getFormatName(CompressedFormat format);
+
+	// Encode 16 RGBA8 texels, row by row, into one block
+	void encodeBC1Block(const unsigned char* texels, unsigned char* block);
+	void encodeBC3Block(const unsigned char* texels, unsigned char* block);
+
+	// Mode 6 only, a single RGBA subset with 4 bit indices
+	void encodeBC7Block(const unsigned char* texels, unsigned char* block);
+
+	// Decode one block into 16 RGBA8 texels, BC7 blocks not in mode 6 come out magenta
+	void decodeBC1Block(const unsigned char* block, unsigned char* texels);
+	void decodeBC3Block(const unsigned char* block, unsigned char* texels);
+	void decodeBC7Block(const unsigned char* block, unsigned char* texels);
+
+	// Encode a whole RGBA8 image, edge blocks repeat the last row and
+	// column, false for formats without an encoder
+	bool compressImage(const unsigned char* pixels, int width, int height, CompressedFormat format, std::vector<unsigned char>& output);
+
+	// Decode a whole image to RGBA8, false for formats without a decoder
+	bool decompressImage(const unsigned char* data, int width, int height, CompressedFormat format, std::vector<unsigned char>& pixels);
+}
@@ -0,0 +1,65 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "BlockCompression.h"
+
+namespace mg
+{
+	struct CompressedLevel
+	{
+		int width;
+		int height;
+
+		// Location in CompressedImage::data
+		size_t offset;
+		size_t size;
+	};
+
+	// Block compressed 2D image with its mip chain, as stored in a DDS or
+	// KTX2 container, rows of blocks are kept in the order of the file
+	struct CompressedImage
+	{
+		CompressedFormat format;
+		bool srgb;
+
+		int width;
+		int height;
+
+		// Rows of blocks start at the bottom of the image, what OpenGL
+		// expects when textures are flipped vertically
+		bool bottomUp;
+
+		// Level 0 first
+		std::vector<CompressedLevel> levels;
+		std::vector<unsigned char> data;
+
+		const unsigned char* getLevelData(size_t level) const { return data.data() + levels[level].offset; }
+	};
+
+	// Whether the extension is one of a container loadCompressedImage reads
+	bool isCompressedImageFile(const std::string& path);
+
+	// Read a DDS or KTX2 file, the container is told by its magic
+	//
+	// DDS has no orientation field, files are taken as top first like
+	// other tools write them unless saveDDS marked them bottom up
+	bool loadCompressedImage(const std::string& path, CompressedImage& image);
+
+	// Write the levels of image, only formats the containers can describe,
+	// bottom up images are marked in a reserved field of the header
+	bool saveDDS(const std::string& path, const CompressedImage& image);
+
+	// Orientation is stored as KTXorientation
+	bool saveKTX2(const std::string& path, const CompressedImage& image);
+
+	// Lay out the levels of an image whose level data is appended in order
+	void addCompressedLevel(CompressedImage& image, const std::vector<unsigned char>& levelData, int levelWidth, int levelHeight);
+}
@@ -0,0 +1,58 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <vector>
+
+namespace mg
+{
+	// Offscreen render target, an RGBA8 colour texture with a depth and
+	// stencil renderbuffer
+	class FrameBuffer
+	{
+
+	private:
+
+		// ID of framebuffer object given by OpenGL
+		unsigned int id;
+
+		unsigned int colorTexture;
+		unsigned int depthStencil;
+
+		int width;
+		int height;
+
+		bool complete;
+
+	public:
+
+		FrameBuffer(int width, int height);
+	   ~FrameBuffer();
+
+		FrameBuffer(const FrameBuffer&) = delete;
+		FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+	public:
+
+		// Draws go to this target, the viewport is set to its size
+		void bind();
+
+		// Back to the default framebuffer, the viewport is left as is
+		void unbind();
+
+		// Whether the driver accepted the attachments, checked once when created
+		bool isComplete() const { return complete; }
+
+		// Copy the colour attachment to pixels as RGBA8, last row first the
+		// way OpenGL stores it, waits for drawing to finish
+		void readPixels(std::vector<unsigned char>& pixels);
+
+		unsigned int getColorTexture() const { return colorTexture; }
+
+		int getWidth() const { return width; }
+		int getHeight() const { return height; }
+	};
+}
@@ -0,0 +1,90 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <chrono>
+
+namespace mg
+{
+	enum class FramePacing
+	{
+		// The swap blocks until the next refresh, the pacer only measures
+		VSYNC,
+		// Frames start at fixed intervals of the target rate
+		CAPPED,
+		// No waiting at all, for profiling
+		UNCAPPED
+	};
+
+	// Keeps frames at a steady rate and measures their duration
+	//
+	// Frames start at absolute deadlines one target interval apart, so time
+	// lost to a late wake up is taken from the next wait instead of adding
+	// up. Waiting sleeps in 1 ms steps while the deadline is further away
+	// than the mean plus one standard deviation of past sleeps, then spins
+	// through the rest
+	class FramePacer
+	{
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		FramePacing mode;
+		Clock::duration targetInterval;
+
+		// Start of the next frame in CAPPED mode
+		Clock::time_point deadline;
+		Clock::time_point frameStart;
+
+		float rawDeltaTime;
+		float deltaTime;
+
+		// Weight of the newest frame in the smoothed delta time
+		float smoothing;
+
+		// Running mean and variance of how long a 1 ms sleep takes, in seconds
+		double sleepMean;
+		double sleepVariance;
+		long long sleepCount;
+
+	public:
+
+		FramePacer(FramePacing mode = FramePacing::VSYNC, float targetRate = 60.0f);
+	   ~FramePacer();
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+	public:
+
+		// The caller enables vertical sync on the window for VSYNC
+		void setMode(FramePacing pacing);
+		void setTargetRate(float framesPerSecond);
+
+		// 1 uses every measured delta as is, lower values average more frames
+		void setSmoothing(float weight) { smoothing = weight; }
+
+		// Call once per frame after presenting, waits for the deadline in
+		// CAPPED mode and measures the frame that ended
+		void endFrame();
+
+		FramePacing getMode() const { return mode; }
+
+		// Smoothed duration of the last frames, in seconds, for simulation
+		float getDeltaTime() const { return deltaTime; }
+
+		// Duration of the last frame alone, in seconds, for statistics
+		float getRawDeltaTime() const { return rawDeltaTime; }
+
+		float getTargetFrameTime() const { return std::chrono::duration<float>(targetInterval).count(); }
+
+	private:
+
+		// Sleep and spin until time, never returns early
+		void waitUntil(Clock::time_point time);
+	};
+}
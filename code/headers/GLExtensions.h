@@ -0,0 +1,151 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <string>
+#include <unordered_set>
+
+// glad is generated for OpenGL 3.3 core, tokens of newer versions and
+// extensions used by the renderer are declared here
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR 0x93D0
+#endif
+
+namespace mg
+{
+	typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+	typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+	typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+	typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+	typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+	typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+	typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+	typedef void (APIENTRYP PFNGLTEXSTORAGE3DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+	typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+	typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+	typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+
+	// Entry points above 3.3 loaded at runtime, null when not supported
+	// by the context, check the matching has* flag before using them
+	class GLExtensions
+	{
+
+	private:
+
+		static int majorVersion;
+		static int minorVersion;
+
+		static std::unordered_set<std::string> extensions;
+
+	public:
+
+		// OpenGL 4.3 or ARB_multi_draw_indirect
+		static bool hasMultiDrawIndirect;
+		static PFNGLMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect;
+
+		// OpenGL 4.4 or ARB_buffer_storage
+		static bool hasBufferStorage;
+		static PFNGLBUFFERSTORAGEPROC bufferStorage;
+
+		// OpenGL 4.1 or ARB_get_program_binary, with at least one binary format
+		static bool hasProgramBinary;
+		static PFNGLGETPROGRAMBINARYPROC getProgramBinary;
+		static PFNGLPROGRAMBINARYPROC programBinary;
+		static PFNGLPROGRAMPARAMETERIPROC programParameteri;
+
+		// KHR or ARB_parallel_shader_compile, GL_COMPLETION_STATUS_KHR can be polled
+		static bool hasParallelShaderCompile;
+		static PFNGLMAXSHADERCOMPILERTHREADSKHRPROC maxShaderCompilerThreads;
+
+		// OpenGL 4.2 or ARB_texture_storage, for 2D and array textures
+		static bool hasTextureStorage;
+		static PFNGLTEXSTORAGE2DPROC texStorage2D;
+		static PFNGLTEXSTORAGE3DPROC texStorage3D;
+
+		// OpenGL 4.6, ARB or EXT_texture_filter_anisotropic, 1 when not supported
+		static bool hasAnisotropicFiltering;
+		static float maxAnisotropy;
+
+		// EXT_texture_compression_s3tc, BC1 and BC3, Texture decodes
+		// BCn formats on the CPU when the driver does not have them
+		static bool hasS3TC;
+		// EXT_texture_sRGB or 4.2 with S3TC
+		static bool hasS3TCsRGB;
+		// OpenGL 4.2 or ARB_texture_compression_bptc, BC7
+		static bool hasBPTC;
+		// OpenGL 4.3 or ARB_ES3_compatibility
+		static bool hasETC2;
+		// KHR_texture_compression_astc_ldr
+		static bool hasASTC;
+
+		// ARB_bindless_texture, textures sampled through 64 bit handles
+		static bool hasBindlessTexture;
+		static PFNGLGETTEXTUREHANDLEARBPROC getTextureHandle;
+		static PFNGLMAKETEXTUREHANDLERESIDENTARBPROC makeTextureHandleResident;
+		static PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC makeTextureHandleNonResident;
+
+	public:
+
+		// Must be called once the context is current and glad is loaded
+		static void load(GLADloadproc loader);
+
+		static bool isVersion(int major, int minor);
+		static bool isSupported(const std::string& extension);
+
+		static int getMajorVersion() { return majorVersion; }
+		static int getMinorVersion() { return minorVersion; }
+	};
+}
@@ -0,0 +1,108 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace mg
+{
+	// Kind of binding tracked by the state cache
+	enum class GLStateKind
+	{
+		PROGRAM,
+		VERTEX_ARRAY,
+		BUFFER,
+		TEXTURE_UNIT,
+		TEXTURE,
+		COUNT
+	};
+
+	struct GLStateCounters
+	{
+		// Calls that reached the driver
+		uint64_t issued [(int)GLStateKind::COUNT];
+
+		// Calls elided because the binding was already current
+		uint64_t skipped[(int)GLStateKind::COUNT];
+
+		uint64_t totalIssued () const;
+		uint64_t totalSkipped() const;
+	};
+
+	// Mirror of the bindings of the current context, every bind goes
+	// through here so calls that would not change anything are skipped
+	//
+	// Code that changes bindings behind its back (SFML drawing, raw GL calls)
+	// must call invalidate() before going back to the cached path
+	class GLStateCache
+	{
+
+	public:
+
+		static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+	private:
+
+		// Binding not known, next bind always reaches the driver
+		static const unsigned int UNKNOWN = 0xFFFFFFFF;
+
+		static const unsigned int BUFFER_TARGET_COUNT  = 8;
+		static const unsigned int UNIFORM_BINDING_COUNT = 36;
+		static const unsigned int TEXTURE_TARGET_COUNT = 3;
+
+		static unsigned int program;
+		static unsigned int vertexArray;
+		static unsigned int activeTextureUnit;
+
+		static unsigned int buffers[BUFFER_TARGET_COUNT];
+		static unsigned int uniformBindings[UNIFORM_BINDING_COUNT];
+		static unsigned int textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+
+		// Element buffer binding is stored in each vertex array
+		static std::unordered_map<unsigned int, unsigned int> elementBuffers;
+
+		static GLStateCounters counters;
+
+	public:
+
+		static void useProgram(unsigned int id);
+		static void bindVertexArray(unsigned int id);
+		static void bindBuffer(unsigned int target, unsigned int id);
+
+		// Indexed binding, also replaces the generic binding of the target
+		static void bindBufferBase(unsigned int target, unsigned int index, unsigned int id);
+		static void activeTexture(unsigned int unit);
+
+		// Bind texture to the given unit, only changing active unit if needed
+		static void bindTexture(unsigned int unit, unsigned int target, unsigned int id);
+
+		// Bind texture to whatever unit is active
+		static void bindTexture(unsigned int target, unsigned int id);
+
+		// Delete objects and forget the bindings OpenGL resets with them
+		static void deleteProgram(unsigned int id);
+		static void deleteVertexArray(unsigned int id);
+		static void deleteBuffer(unsigned int id);
+		static void deleteTexture(unsigned int id);
+
+		static unsigned int getProgram() { return program; }
+		static unsigned int getVertexArray() { return vertexArray; }
+
+		// Forget every binding
+		static void invalidate();
+
+		static const GLStateCounters& getCounters() { return counters; }
+		static void resetCounters();
+
+	private:
+
+		static int bufferTargetIndex(unsigned int target);
+		static int textureTargetIndex(unsigned int target);
+
+		static bool changed(unsigned int& current, unsigned int id, GLStateKind kind);
+	};
+}
@@ -0,0 +1,148 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mg
+{
+	struct ProfileTrack;
+
+	// GPU time of a section of the last frame read back
+	struct GPUZoneResult
+	{
+		const char* name;
+
+		// Nesting level, 0 for sections not inside another one
+		unsigned int depth;
+
+		double milliseconds;
+	};
+
+	// Measures GPU time of sections of a frame with GL_TIMESTAMP queries
+	//
+	// Every section writes a timestamp where it begins and ends. Queries of
+	// a frame are read back FRAME_LATENCY frames later, when the GPU has
+	// finished with them, so reading never waits for it. Frames still not
+	// finished by then are skipped
+	//
+	// While the CPU profiler records, sections are also added to a GPU
+	// track of its capture, next to the CPU zones
+	class GPUProfiler
+	{
+
+	public:
+
+		static const unsigned int FRAME_LATENCY = 3;
+
+		// Sections past this in a frame are not measured
+		static const unsigned int MAX_ZONES = 256;
+
+	private:
+
+		struct Zone
+		{
+			const char* name;
+			unsigned int depth;
+		};
+
+		struct Frame
+		{
+			// Two queries per zone, begin and end, created on demand
+			std::vector<unsigned int> queries;
+			std::vector<Zone> zones;
+
+			// Added to the CPU capture, when the profiler was recording as the frame began
+			bool traced;
+
+			// Profiler time minus GPU time, to put both clocks on one timeline
+			int64_t clockOffset;
+
+			bool pending;
+		};
+
+		// Scopes measure on the profiler created last
+		static GPUProfiler* current;
+
+		Frame frames[FRAME_LATENCY];
+		unsigned int frameIndex;
+		bool inFrame;
+		unsigned int depth;
+
+		std::vector<GPUZoneResult> results;
+		double frameMilliseconds;
+		uint64_t skippedFrames;
+
+		ProfileTrack& track;
+
+	public:
+
+		GPUProfiler();
+	   ~GPUProfiler();
+
+		GPUProfiler(const GPUProfiler&) = delete;
+		GPUProfiler& operator=(const GPUProfiler&) = delete;
+
+	public:
+
+		// Call once at the start and end of each frame, beginFrame reads back
+		// the frame FRAME_LATENCY frames ago
+		void beginFrame();
+		void endFrame();
+
+		// Index for endZone, or MAX_ZONES when the section is not measured
+		unsigned int beginZone(const char* name);
+		void endZone(unsigned int zone);
+
+		// Sections of the last frame read back, in the order they began,
+		// the first one is the whole frame
+		const std::vector<GPUZoneResult>& getResults() const { return results; }
+
+		// GPU time from beginFrame to endFrame of the same frame
+		double getFrameMilliseconds() const { return frameMilliseconds; }
+
+		// Frames not finished by the GPU when their queries were read back
+		uint64_t getSkippedFrames() const { return skippedFrames; }
+
+		// Last frame's sections on one line, for the console
+		std::string getSummary() const;
+
+		static GPUProfiler* getCurrent() { return current; }
+
+	private:
+
+		void readBack(Frame& frame);
+	};
+
+	// Measures GPU time until the end of the scope on the current GPUProfiler,
+	// nothing when there is none or it is outside a frame
+	class GPUProfileScope
+	{
+
+	private:
+
+		GPUProfiler* profiler;
+		unsigned int zone;
+
+	public:
+
+		explicit GPUProfileScope(const char* name)
+			: profiler(GPUProfiler::getCurrent()), zone(profiler ? profiler->beginZone(name) : GPUProfiler::MAX_ZONES)
+		{
+		}
+
+	   ~GPUProfileScope()
+		{
+			if (zone != GPUProfiler::MAX_ZONES)
+				profiler->endZone(zone);
+		}
+
+		GPUProfileScope(const GPUProfileScope&) = delete;
+		GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+	};
+}
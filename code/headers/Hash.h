@@ -0,0 +1,42 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mg
+{
+	// FNV-1a, usable in constant expressions so names known at compile
+	// time cost nothing to hash at runtime
+	constexpr uint32_t fnv1a32(const char* data, size_t length, uint32_t hash = 2166136261u)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (uint8_t)data[i];
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	constexpr uint64_t fnv1a64(const char* data, size_t length, uint64_t hash = 14695981039346656037ull)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= (uint8_t)data[i];
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	// Hash for maps keyed by an already hashed value
+	struct IdentityHash
+	{
+		size_t operator()(uint32_t value) const { return value; }
+	};
+}
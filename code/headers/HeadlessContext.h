@@ -0,0 +1,52 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+namespace mg
+{
+	// OpenGL context without a window, for benchmarks and image tests on
+	// machines with no display or GPU
+	//
+	// Uses EGL on Linux, surfaceless where Mesa offers it and a pbuffer
+	// elsewhere, which also runs on the llvmpipe software rasterizer.
+	// Other platforms use an SFML context, made current on a hidden window.
+	// Nothing is shown on screen, draw into a FrameBuffer and read it back
+	class HeadlessContext
+	{
+
+	private:
+
+		// EGLDisplay, EGLContext and EGLSurface, kept opaque so EGL
+		// headers stay out of every file including this one, only the
+		// context is used, as an sf::Context, on other platforms
+		void* display;
+		void* context;
+		void* surface;
+
+	public:
+
+		HeadlessContext();
+	   ~HeadlessContext();
+
+		HeadlessContext(const HeadlessContext&) = delete;
+		HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	public:
+
+		// Create a core profile context of the version and make it current,
+		// false with the reason printed when it is not available
+		bool create(int majorVersion, int minorVersion);
+
+		bool isCreated() const { return context != nullptr; }
+
+		// Loader for glad and GLExtensions
+		static void* getFunction(const char* name);
+
+	private:
+
+		void destroy();
+	};
+}
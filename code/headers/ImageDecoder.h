@@ -0,0 +1,43 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace mg
+{
+	// Pixels of a decoded file, 8 bits per channel, rows of width * channels
+	// bytes without padding
+	struct DecodedImage
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+
+		// Released with the function of the decoder that allocated it
+		std::unique_ptr<unsigned char, void (*)(void*)> pixels { nullptr, std::free };
+	};
+
+	// Decodes a file held in memory, top row first
+	// desiredChannels of 0 keeps the channels stored in the file
+	using ImageDecodeFunction = std::function<bool(const unsigned char* data, size_t size, int desiredChannels, DecodedImage& image)>;
+
+	// Decode files with the extension, e.g. ".jpg", with another library
+	// such as libjpeg-turbo, stb_image decodes everything else
+	// Not thread safe, register decoders before any texture is loaded
+	void setImageDecoder(const std::string& extension, ImageDecodeFunction decoder);
+
+	// Read and decode a file, flipped puts the last row first the way
+	// OpenGL expects, without it texture coordinates must flip v instead
+	bool decodeImage(const std::string& path, DecodedImage& image, int desiredChannels = 0, bool flipped = true);
+
+	// Reverse the order of the rows in place
+	void flipImageRows(unsigned char* pixels, size_t rowSize, int height);
+}
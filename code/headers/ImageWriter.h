@@ -0,0 +1,18 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <string>
+
+namespace mg
+{
+	// Write an RGBA8 image as a PNG, flipped writes the last row first so
+	// images in the orientation of Texture come out upright
+	//
+	// Pixels are stored without compression, it is meant for tools and
+	// captures, not for shipping assets
+	bool writePNG(const std::string& path, const unsigned char* pixels, int width, int height, bool flipped);
+}
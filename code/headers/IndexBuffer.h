@@ -20,6 +20,7 @@ namespace mg
 
 	public:
 
+		// Data can be null to allocate storage filled later with setData
 		IndexBuffer(const unsigned int* data, unsigned int bufferCount);
 	   ~IndexBuffer();
 
@@ -28,6 +29,9 @@ namespace mg
 		void bind();
 		void unbind();
 
+		// Offset and count are in indices
+		void setData(const unsigned int* data, unsigned int dataCount, unsigned int offset = 0);
+
 		unsigned int GetCount() const { return count; }
 	};
 }
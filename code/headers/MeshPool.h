@@ -0,0 +1,77 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <memory>
+
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+namespace mg
+{
+	// Layout of one command in GL_DRAW_INDIRECT_BUFFER
+	struct DrawElementsIndirectCommand
+	{
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int          baseVertex;
+		unsigned int baseInstance;
+	};
+
+	// Place of a mesh inside the shared buffers of a pool
+	struct MeshRange
+	{
+		unsigned int firstIndex;
+		unsigned int indexCount;
+		int          baseVertex;
+
+		DrawElementsIndirectCommand command(unsigned int instanceCount = 1, unsigned int baseInstance = 0) const
+		{
+			return { indexCount, instanceCount, firstIndex, baseVertex, baseInstance };
+		}
+	};
+
+	// Vertex and index buffers shared by many meshes of the same layout,
+	// so every mesh of the pool draws with a single vertex array bind
+	class MeshPool
+	{
+
+	private:
+
+		VertexArray vertexArray;
+		VertexBuffer vertexBuffer;
+		std::unique_ptr<IndexBuffer> indexBuffer;
+
+		unsigned int vertexStride;
+
+		unsigned int maxVertices;
+		unsigned int maxIndices;
+
+		unsigned int vertexCount;
+		unsigned int indexCount;
+
+	public:
+
+		MeshPool(const VertexBufferLayout& layout, unsigned int maxVertexCount, unsigned int maxIndexCount);
+
+		MeshPool(const MeshPool&) = delete;
+		MeshPool& operator=(const MeshPool&) = delete;
+
+	public:
+
+		// Indices are relative to the first vertex of the mesh
+		// Returns an empty range if the pool is full
+		MeshRange addMesh(const void* vertices, unsigned int meshVertexCount, const unsigned int* indices, unsigned int meshIndexCount);
+
+		VertexArray& getVertexArray() { return vertexArray; }
+		IndexBuffer& getIndexBuffer() { return *indexBuffer; }
+
+		unsigned int getVertexCount() const { return vertexCount; }
+		unsigned int getIndexCount () const { return  indexCount; }
+	};
+}
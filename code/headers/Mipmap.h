@@ -0,0 +1,40 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace mg
+{
+	// Size of a dimension at a mip level, never below 1
+	inline int getMipSize(int size, unsigned int level)
+	{
+		int mipSize = size >> level;
+		return mipSize > 0 ? mipSize : 1;
+	}
+
+	// Levels down to 1x1, including the base one
+	unsigned int getMipLevelCount(int width, int height);
+
+	// Half size RGBA8 image with a 2x2 box filter, the last row or column of
+	// an odd size is dropped and a size of 1 is filtered with itself
+	// Destination holds getMipSize(width, 1) * getMipSize(height, 1) texels
+	void downsampleRGBA8(const unsigned char* source, int width, int height, unsigned char* destination);
+
+	// Same filter for 1 to 4 channels of 8 bits, RGBA8 takes the SIMD path
+	void downsampleImage(const unsigned char* source, int width, int height, int channels, unsigned char* destination);
+
+	// Levels 1 to levelCount - 1 of an image, each one filtered from the
+	// previous one and stored right after it, rows are not padded
+	std::vector<unsigned char> buildMipChain(const unsigned char* pixels, int width, int height, unsigned int levelCount, int channels = 4);
+
+	// Bytes of a level, rows are not padded
+	inline size_t getMipByteSize(int width, int height, unsigned int level, int channels = 4)
+	{
+		return (size_t)getMipSize(width, level) * getMipSize(height, level) * channels;
+	}
+}
@@ -0,0 +1,98 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace mg
+{
+	struct ProfileTrack;
+
+	// Span of time spent in a named part of the code, in nanoseconds since
+	// the profiler started
+	struct ProfileZone
+	{
+		// String literal, only the pointer is stored
+		const char* name;
+
+		uint64_t start;
+		uint64_t end;
+	};
+
+	// Records zones of every thread during a capture of a few frames and
+	// writes them as a Chrome trace, open it in chrome://tracing or
+	// ui.perfetto.dev
+	//
+	// Each thread writes its zones to its own ring buffer without locks,
+	// frameMark drains the buffers once per frame. Outside a capture zones
+	// cost one atomic load
+	class Profiler
+	{
+
+	private:
+
+		static std::atomic<bool> recording;
+
+	public:
+
+		static bool isRecording() { return recording.load(std::memory_order_relaxed); }
+
+		// Nanoseconds since the profiler started
+		static uint64_t now();
+
+		// Add a finished zone to the buffer of the calling thread
+		static void record(const char* name, uint64_t start, uint64_t end);
+
+		// Timeline of work that does not run on a CPU thread, such as the
+		// GPU, only one thread at a time may record to it
+		static ProfileTrack& createTrack(const std::string& name);
+		static void record(ProfileTrack& track, const char* name, uint64_t start, uint64_t end);
+
+		// Shown as the name of the calling thread in captures
+		static void setThreadName(const std::string& name);
+
+		// Call once per frame from the main thread, ends the frame that was
+		// running and starts and finishes captures
+		static void frameMark();
+
+		// Record the next frameCount frames and write them to path, Chrome
+		// trace event JSON, false while another capture is running
+		static bool captureFrames(unsigned int frameCount, const std::string& path);
+
+		static bool isCapturing();
+	};
+
+	// Records the time until the end of the scope as a zone
+	//
+	//     ProfileScope profile("Renderer::draw");
+	class ProfileScope
+	{
+
+	private:
+
+		// Null when no capture was recording at the start
+		const char* name;
+		uint64_t start;
+
+	public:
+
+		explicit ProfileScope(const char* zoneName)
+			: name(Profiler::isRecording() ? zoneName : nullptr), start(name ? Profiler::now() : 0)
+		{
+		}
+
+	   ~ProfileScope()
+		{
+			if (name)
+				Profiler::record(name, start, Profiler::now());
+		}
+
+		ProfileScope(const ProfileScope&) = delete;
+		ProfileScope& operator=(const ProfileScope&) = delete;
+	};
+}
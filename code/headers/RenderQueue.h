@@ -0,0 +1,68 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mg
+{
+	class Shader;
+	class Texture;
+	class VertexArray;
+	class IndexBuffer;
+
+	// Draw recorded by the renderer to be issued on flush
+	struct DrawCommand
+	{
+		VertexArray* vertexArray;
+		IndexBuffer* indexBuffer;
+		Shader*      shader;
+		Texture*     texture;
+
+		// 1 for a regular draw
+		unsigned int instanceCount;
+	};
+
+	// Queue of draws sorted by a 64 bit key so that draws sharing
+	// state end up together and only state changes are issued
+	//
+	// Key layout (most significant first):
+	// | shader 16 | texture 16 | vertex array 16 | depth 16 |
+	class RenderQueue
+	{
+
+	private:
+
+		struct SortEntry
+		{
+			uint64_t key;
+			uint32_t command;
+		};
+
+		std::vector<DrawCommand> commands;
+
+		std::vector<SortEntry> entries;
+		std::vector<SortEntry> scratch;
+
+	public:
+
+		void submit(const DrawCommand& command, float depth);
+
+		// Sort recorded draws, issue them and empty the queue
+		void flush();
+
+		size_t size() const { return commands.size(); }
+		bool  empty() const { return commands.empty(); }
+
+		static uint64_t makeKey(const DrawCommand& command, float depth);
+
+	private:
+
+		void sort();
+	};
+}
@@ -0,0 +1,112 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GLStateCache.h"
+
+namespace mg
+{
+	// Counters of a single frame
+	enum class RenderStat
+	{
+		DRAW_CALLS,
+		TRIANGLES,
+		// Bindings that reached the driver, of every kind
+		STATE_CHANGES,
+		// glUniform calls and uniform buffer updates
+		UNIFORM_UPLOADS,
+		// Bytes written to vertex, index, uniform, indirect and streaming buffers
+		BUFFER_BYTES,
+		TEXTURE_BINDS,
+		SHADER_SWITCHES,
+		COUNT
+	};
+
+	struct FrameStats
+	{
+		uint64_t drawCalls;
+		uint64_t triangles;
+		uint64_t uniformUploads;
+		uint64_t bufferBytes;
+
+		// Bindings of the frame, texture binds and shader switches are
+		// the TEXTURE and PROGRAM kinds
+		GLStateCounters stateChanges;
+
+		uint64_t get(RenderStat stat) const;
+	};
+
+	// Spread of a counter over the frames in the history
+	struct StatSummary
+	{
+		uint64_t min;
+		double average;
+		uint64_t p99;
+		uint64_t max;
+	};
+
+	// Counts the work the renderer hands to the driver each frame and keeps
+	// the last frames for budgets and regression checks
+	//
+	// Counters are plain integers bumped by the code issuing the GL calls,
+	// render thread only. Bindings come from the GLStateCache counters
+	class RenderStats
+	{
+
+	private:
+
+		static FrameStats current;
+
+		// Ring of finished frames, next is where the following one goes
+		static std::vector<FrameStats> history;
+		static size_t next;
+		static size_t frameCount;
+
+		// Cache counters when the current frame started
+		static GLStateCounters stateAtFrameStart;
+
+	public:
+
+		static void countDraw(uint64_t indexCount, uint64_t instanceCount = 1)
+		{
+			current.drawCalls++;
+			current.triangles += indexCount / 3 * instanceCount;
+		}
+
+		// Draw calls and triangles separately, for multi draws that issue
+		// several meshes in one call
+		static void countDraws(uint64_t drawCalls, uint64_t triangles)
+		{
+			current.drawCalls += drawCalls;
+			current.triangles += triangles;
+		}
+
+		static void countUniformUpload() { current.uniformUploads++; }
+		static void countBufferUpload(size_t bytes) { current.bufferBytes += bytes; }
+
+		// Call once per frame, after its last draw, finishes the frame and
+		// adds it to the history
+		static void endFrame();
+
+		// Last finished frame
+		static const FrameStats& getLastFrame();
+
+		// Frames in the history, at most the history size
+		static size_t getFrameCount() { return frameCount; }
+
+		// Frames kept for summaries, 300 by default, clears the history
+		static void setHistorySize(size_t frames);
+
+		// Min, average, 99th percentile and max of a counter over the history
+		static StatSummary summarize(RenderStat stat);
+
+		static const char* getName(RenderStat stat);
+	};
+}
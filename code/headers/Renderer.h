@@ -11,21 +11,66 @@
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "RenderQueue.h"
+#include "MeshPool.h"
 
 namespace mg
 {
+	class Texture;
+
 	void GLClearError();
 	bool GLLogCall();
 
+	enum class SubmitMode
+	{
+		// Draws are issued as soon as they are requested
+		IMMEDIATE,
+		// Draws are recorded and issued sorted by state on flush,
+		// uniforms are read at flush time so they must be set per shader, not per draw
+		DEFERRED
+	};
+
 	class Renderer
 	{
 
 	private:
 
+		SubmitMode submitMode;
+		RenderQueue queue;
+
+		// Commands of multi draw indirect, grown on demand
+		unsigned int indirectBuffer;
+		size_t indirectBufferSize;
+
 	public:
 
+		Renderer();
+	   ~Renderer();
+
+		Renderer(const Renderer&) = delete;
+		Renderer& operator=(const Renderer&) = delete;
+
+		void setSubmitMode(SubmitMode mode);
+		SubmitMode getSubmitMode() const { return submitMode; }
+
 		void clear();
+
+		// Draws with a shader that is not ready() yet are skipped
 		void draw(VertexArray& vertexArray, IndexBuffer& indexBuffer, Shader& shader);
+
+		// Depth in [0, 1] is only used to order draws that share state in deferred mode
+		void draw(VertexArray& vertexArray, IndexBuffer& indexBuffer, Shader& shader, Texture& texture, float depth = 0.0f);
+
+		// Draw the mesh instanceCount times, per instance data comes from
+		// buffers added to the vertex array with a non zero divisor
+		void drawInstanced(VertexArray& vertexArray, IndexBuffer& indexBuffer, Shader& shader, unsigned int instanceCount);
+
+		// Draw meshes of the pool with one glMultiDrawElementsIndirect call,
+		// on contexts older than 4.3 each command is issued with glDrawElementsBaseVertex
+		// (baseInstance is ignored there), always immediate regardless of submit mode
+		void drawIndirect(MeshPool& pool, Shader& shader, const std::vector<DrawElementsIndirectCommand>& commands);
+
+		// Issue every draw recorded in deferred mode
+		void flush();
 	};
 }
-
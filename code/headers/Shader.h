@@ -5,16 +5,71 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <glm/glm.hpp>
 
+#include "Hash.h"
+#include "ShaderParser.h"
+#include "ShaderReflection.h"
+
 namespace mg
 {
 	struct ShaderSource
 	{
 		std::string vertexSource;
 		std::string fragmentSource;
+
+		ShaderSourceView view() const { return { vertexSource, fragmentSource }; }
+	};
+
+	// Uniform resolved once with Shader::uniform, setting through it does
+	// no name lookup, only an index into the uniforms of the shader
+	//
+	// Handles stay valid when the shader is reloaded, the location
+	// behind them is resolved again against the new program
+	struct UniformHandle
+	{
+		int slot;
+
+		explicit UniformHandle(int uniformSlot = -1) : slot(uniformSlot)
+		{ }
+
+		bool isValid() const { return slot != -1; }
+	};
+
+	// Uniform name with its hash, computed at compile time from a literal
+	// when declared constexpr, e.g. static constexpr UniformName color = "u_Color";
+	struct UniformName
+	{
+		uint32_t hash;
+		const char* name;
+
+		template<size_t N>
+		constexpr UniformName(const char (&literal)[N]) : hash(fnv1a32(literal, N - 1)), name(literal)
+		{ }
+
+		// Only valid while the string is alive
+		UniformName(const std::string& string) : hash(fnv1a32(string.data(), string.size())), name(string.c_str())
+		{ }
+	};
+
+	class ShaderCache;
+	class ShaderPreprocessor;
+
+	enum class ShaderCompileMode
+	{
+		// Constructor returns with the program linked
+		BLOCKING,
+		// Constructor only issues compile and link, poll ready() before use
+		ASYNC
+	};
+
+	enum class ShaderState
+	{
+		COMPILING, READY, FAILED
 	};
 
 	class Shader
@@ -22,14 +77,47 @@ namespace mg
 
 	private:
 
+		// Shared by every shader, null disables caching
+		static ShaderCache* programCache;
+
 		std::string path;
 		unsigned int id;
-		
-		std::unordered_map< std::string, int > uniformLocationCache;
+
+		ShaderState state;
+
+		// Program being built by reload, the current one is kept until it links
+		unsigned int pendingId;
+		bool pendingChecked;
+
+		// Stages kept until the result of the link is checked
+		unsigned int vertexShader;
+		unsigned int fragmentShader;
+
+		// Store program in the cache once linked
+		bool storeInCache;
+		uint64_t cacheKey;
+
+		struct UniformSlot
+		{
+			std::string name;
+			int location;
+		};
+
+		// Resolved again every time the program changes
+		std::vector<UniformSlot> uniformSlots;
+
+		// Slot index keyed by name hash, names sharing a hash get a slot each
+		std::unordered_multimap< uint32_t, int, IdentityHash > uniformSlotCache;
+
+		// Interface of the current program
+		ShaderReflection reflection;
 
 	public:
 
-		Shader(const std::string& shaderPath);
+		Shader(const std::string& shaderPath, ShaderCompileMode mode = ShaderCompileMode::BLOCKING);
+
+		// Stages already split, name is only used in messages
+		Shader(const ShaderSource& source, const std::string& name, ShaderCompileMode mode = ShaderCompileMode::BLOCKING);
 	   ~Shader();
 
 	public:
@@ -37,17 +125,90 @@ namespace mg
 		void bind() const;
 		void unbind() const;
 
+		unsigned int getId() const { return id; }
+		const std::string& getPath() const { return path; }
+
+		// Whether the program can be used, never blocks when the driver
+		// supports parallel shader compile, otherwise the first call waits
+		bool ready();
+		ShaderState getState() const { return state; }
+
+		// Build a new program from a preprocessed .shader file, the current
+		// program stays in use until the new one links and is dropped if it
+		// fails, so a broken edit never leaves the shader unusable
+		void reload(const std::string& text);
+
+		// Swap in the reloaded program once it links, true while still compiling
+		bool updateReload();
+		bool isReloading() const { return pendingId != 0; }
+
+		// Resolve location once for the hot path
+		UniformHandle uniform(UniformName name);
+
+		// Empty until the program links
+		const ShaderReflection& getReflection() const { return reflection; }
+
+		// Whether a vertex array built from these layouts, added in this
+		// order, feeds every attribute, mismatches are printed
+		bool validateLayout(const VertexBufferLayout& layout);
+		bool validateLayouts(const std::vector<const VertexBufferLayout*>& layouts);
+
 		// Set uniforms
-		void setUniform4f(const std::string& name, glm::vec4 vec);
-		void setUniform1i(const std::string& name, int value);
-		void setUniformMat4f(const std::string& name, glm::mat4& mat);
+		void setUniform4f(UniformName name, glm::vec4 vec);
+		void setUniform1i(UniformName name, int value);
+		void setUniform1iv(UniformName name, int count, const int* values);
+		void setUniformMat4f(UniformName name, const glm::mat4& mat);
+
+		void setUniform4f(UniformHandle handle, glm::vec4 vec);
+		void setUniform1i(UniformHandle handle, int value);
+		void setUniform1iv(UniformHandle handle, int count, const int* values);
+		void setUniformMat4f(UniformHandle handle, const glm::mat4& mat);
+
+		// Split a preprocessed .shader file in its stages
+		static ShaderSource parseSource(const std::string& text);
+
+		// Cache must outlive the shaders created while it is set
+		static void setProgramCache(ShaderCache* cache) { programCache = cache; }
+
+		// Shared by every shader loaded from a file, includes like
+		// FrameData.glsl are read once, render thread only
+		static ShaderPreprocessor& getPreprocessor();
 
 	private:
 
-		int getUniformLocation(const std::string& name);
+		int getUniformLocation(UniformName name);
+		int getUniformSlot(UniformName name);
+
+		int getHandleLocation(UniformHandle handle) const
+		{
+			return handle.slot != -1 ? uniformSlots[handle.slot].location : -1;
+		}
+
+		// Read the interface of the current program and resolve every uniform against it
+		void reflectProgram();
+
+		// Location from the reflection tables, -1 with a warning when not active
+		int findUniformLocation(UniformName name) const;
+
+		void create(const ShaderSourceView& source, ShaderCompileMode mode);
+
+		// Program from the cache, already linked, or compiled from source
+		unsigned int loadProgram(const ShaderSourceView& source, bool& cached);
+
+		// Whether the link result can be queried without waiting
+		bool linkCompleted(unsigned int program) const;
+
+		// Replace the program with the pending one
+		void swapProgram();
+
+		// Values set on the old program carry over, e.g. sampler units set once
+		static void copyUniforms(unsigned int from, unsigned int to);
+
+		unsigned int compileShader(unsigned int type, std::string_view source);
+		unsigned int createShader(std::string_view vertexShaderCode, std::string_view fragmentShaderCode);
 
-		ShaderSource parseShader(const std::string& path);
-		unsigned int compileShader(unsigned int type, const std::string& source);
-		unsigned int createShader(const std::string& vertexShaderCode, const std::string& fragmentShaderCode);
+		// Check results of compile and link, then run post link steps
+		bool finishProgram(unsigned int program);
+		bool checkShader(unsigned int shader, unsigned int type);
 	};
 }
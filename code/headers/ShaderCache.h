@@ -0,0 +1,53 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace mg
+{
+	// Linked programs stored on disk with glGetProgramBinary, keyed by the
+	// shader source and the driver that produced them, so the next run
+	// skips compiling and linking
+	//
+	// A binary rejected by the driver (e.g. after an update) is deleted and
+	// the program is compiled from source again
+	class ShaderCache
+	{
+
+	private:
+
+		std::string directory;
+
+		// Vendor, renderer and version of the context, part of every key
+		std::string driver;
+
+		bool enabled;
+
+	public:
+
+		// Context must be current, directory is created if missing
+		ShaderCache(const std::string& cacheDirectory);
+
+	public:
+
+		uint64_t makeKey(std::string_view vertexSource, std::string_view fragmentSource) const;
+
+		// Linked program created from the cached binary, 0 on a miss
+		unsigned int load(uint64_t key) const;
+
+		// Program must have been linked with the retrievable hint
+		void store(unsigned int program, uint64_t key) const;
+
+		bool isEnabled() const { return enabled; }
+
+	private:
+
+		std::string getFilePath(uint64_t key) const;
+	};
+}
@@ -0,0 +1,27 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace mg
+{
+	// Stages of a .shader file as slices of the text they were split from,
+	// only valid while that text is alive
+	struct ShaderSourceView
+	{
+		std::string_view vertexSource;
+		std::string_view fragmentSource;
+	};
+
+	// Read a whole file with a single read, false if it can not be opened
+	bool readTextFile(const std::string& path, std::string& contents);
+
+	// Split text in one pass at lines starting with "#shader vertex" or
+	// "#shader fragment", text before the first marker is ignored
+	ShaderSourceView splitShaderSource(std::string_view text);
+}
@@ -0,0 +1,51 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace mg
+{
+	// Expands #include "file" directives of shader files, paths are
+	// relative to the including file
+	//
+	// Every file is read from disk once per preprocessor and kept for later
+	// expansions, Shader::getPreprocessor shares one across shader loads.
+	// A file is only pasted once per stage, as if every include had an
+	// include guard
+	class ShaderPreprocessor
+	{
+
+	private:
+
+		std::unordered_map<std::string, std::string> fileCache;
+
+		// Files read by the last process call
+		std::vector<std::string> dependencies;
+
+	public:
+
+		// Source of the file with every include expanded, empty if it can not be read
+		std::string process(const std::string& path);
+
+		// The processed file and everything it included, paths normalized
+		const std::vector<std::string>& getDependencies() const { return dependencies; }
+
+		// Forget files read so far, e.g. after they changed on disk
+		void clearCache();
+
+		// Add #define lines right after the #version line of a stage
+		static std::string injectDefines(const std::string& stageSource, const std::vector<std::string>& defines);
+
+	private:
+
+		bool expand(const std::string& path, std::string& output, std::unordered_set<std::string>& included);
+		const std::string* readFile(const std::string& path);
+	};
+}
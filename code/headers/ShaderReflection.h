@@ -0,0 +1,86 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mg
+{
+	class VertexBufferLayout;
+
+	// Active uniform or attribute of a linked program
+	struct ShaderVariable
+	{
+		uint32_t hash;
+		int location;
+
+		// GL type, e.g. GL_FLOAT_VEC4
+		unsigned int type;
+
+		// Elements, 1 unless it is an array
+		int size;
+	};
+
+	// Active uniform block of a linked program
+	struct ShaderBlock
+	{
+		uint32_t hash;
+		unsigned int index;
+		unsigned int binding;
+
+		// Bytes the program expects the bound buffer to hold
+		int dataSize;
+	};
+
+	// Everything the driver reports about a program, read once after it
+	// links so no lookup has to go back to the driver
+	//
+	// Tables are sorted by name hash and searched with a binary search,
+	// names are kept apart in the same order to confirm a match
+	class ShaderReflection
+	{
+
+	private:
+
+		std::vector<ShaderVariable> uniforms;
+		std::vector<ShaderVariable> attributes;
+		std::vector<ShaderBlock> blocks;
+
+		std::vector<std::string> uniformNames;
+		std::vector<std::string> attributeNames;
+		std::vector<std::string> blockNames;
+
+	public:
+
+		// Replace the tables with the interface of a linked program
+		void reflect(unsigned int program);
+
+		// Null when the program has no such active variable, the hash finds
+		// the entry and the name confirms it
+		const ShaderVariable* findUniform(uint32_t hash, const char* name) const;
+		const ShaderVariable* findAttribute(uint32_t hash, const char* name) const;
+		const ShaderBlock* findBlock(uint32_t hash, const char* name) const;
+
+		const std::vector<ShaderVariable>& getUniforms() const { return uniforms; }
+		const std::vector<ShaderVariable>& getAttributes() const { return attributes; }
+		const std::vector<ShaderBlock>& getBlocks() const { return blocks; }
+
+		// Whether buffers with these layouts, added to a vertex array in
+		// this order, feed every attribute with data it can read
+		//
+		// Attributes left without data, or integer attributes fed through
+		// glVertexAttribPointer, fail, data no attribute reads only warns
+		bool validateLayouts(const std::vector<const VertexBufferLayout*>& layouts, const std::string& shaderName) const;
+
+		// Locations taken by an attribute of the type, one per matrix column
+		static unsigned int getLocationCount(unsigned int type);
+
+		// Whether the type is read with glVertexAttribIPointer
+		static bool isIntegerType(unsigned int type);
+	};
+}
@@ -0,0 +1,62 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+namespace mg
+{
+	// Permutations of one .shader file, each bit of a variant mask turns
+	// on one keyword defined before the code of both stages
+	//
+	// ShaderVariants sprites("Sprite.shader", { "TEXTURED", "VERTEX_COLOR", "INSTANCED" });
+	// Shader& shader = sprites.get(TEXTURED | INSTANCED);
+	//
+	// The file is read and its includes expanded once, variants are
+	// compiled the first time they are asked for and kept afterwards
+	class ShaderVariants
+	{
+
+	private:
+
+		std::string path;
+		std::vector<std::string> keywords;
+
+		ShaderCompileMode compileMode;
+
+		// Stages with includes expanded, shared by every variant
+		ShaderSource source;
+
+		std::unordered_map<uint32_t, std::unique_ptr<Shader>> variants;
+
+	public:
+
+		ShaderVariants(const std::string& shaderPath, const std::vector<std::string>& variantKeywords,
+			ShaderCompileMode mode = ShaderCompileMode::BLOCKING);
+
+		ShaderVariants(const ShaderVariants&) = delete;
+		ShaderVariants& operator=(const ShaderVariants&) = delete;
+
+	public:
+
+		// Variant with the keywords of the mask defined, compiled on first use
+		Shader& get(uint32_t mask);
+
+		// Compile variants up front, e.g. while loading
+		void precompile(const std::vector<uint32_t>& masks);
+
+		// Mask of the given keywords, unknown ones are ignored
+		uint32_t getMask(const std::vector<std::string>& enabledKeywords) const;
+
+		size_t getCompiledCount() const { return variants.size(); }
+	};
+}
@@ -0,0 +1,111 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ShaderPreprocessor.h"
+
+namespace mg
+{
+	class Shader;
+
+	// Reloads shaders when their .shader file, or any file it includes,
+	// changes on disk
+	//
+	// A background thread waits for changes, inotify on Linux and polling
+	// of write times elsewhere or when inotify fails, then reads and
+	// preprocesses the new source. GL calls stay on the render thread:
+	// update hands the source to the shader, which compiles the new program
+	// next to the current one and swaps them once it links
+	class ShaderWatcher
+	{
+
+	private:
+
+		struct Reload
+		{
+			Shader* shader;
+			std::string text;
+		};
+
+		// Guards everything shared with the watcher thread
+		std::mutex mutex;
+
+		// Files each shader was built from, its own path first
+		std::unordered_map<Shader*, std::vector<std::string>> watched;
+
+		// Preprocessed sources waiting for the render thread
+		std::vector<Reload> reloads;
+
+		// Render thread only, shaders with a program still compiling
+		std::vector<Shader*> compiling;
+
+		// Watcher thread only
+		ShaderPreprocessor preprocessor;
+
+#ifdef __linux__
+		// -1 when inotify is not available, files are polled instead
+		int inotifyDescriptor;
+
+		// Directory of each inotify watch
+		std::unordered_map<int, std::string> directories;
+#endif
+
+		// Last write time seen of every polled file
+		std::unordered_map<std::string, std::filesystem::file_time_type> writeTimes;
+
+		std::atomic<bool> running;
+		std::thread thread;
+
+	public:
+
+		ShaderWatcher();
+	   ~ShaderWatcher();
+
+		ShaderWatcher(const ShaderWatcher&) = delete;
+		ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+	public:
+
+		// Shader has to be created from a file and be unwatched before it is destroyed
+		void watch(Shader& shader);
+		void unwatch(Shader& shader);
+
+		// Start queued reloads and swap in the ones that linked, call once
+		// per frame from the thread owning the context
+		void update();
+
+	private:
+
+		void run();
+
+		// Files that changed, empty when woken up to stop
+		std::unordered_set<std::string> waitForChanges();
+
+		void reloadChanged(const std::unordered_set<std::string>& changedFiles);
+
+		// Start watching new files of a shader, mutex has to be held
+		void addFiles(const std::vector<std::string>& files);
+
+		// Write times of the files, checked every 250 ms
+		std::unordered_set<std::string> pollWriteTimes();
+		void addWriteTimes(const std::vector<std::string>& files);
+
+#ifdef __linux__
+		// Events of watches on the directories of the files
+		std::unordered_set<std::string> waitForEvents();
+		void addWatches(const std::vector<std::string>& files);
+#endif
+	};
+}
@@ -0,0 +1,125 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "VertexArray.h"
+#include "StreamingBuffer.h"
+#include "IndexBuffer.h"
+
+namespace mg
+{
+	class Shader;
+	class Texture;
+	class TextureArray;
+	class TextureAtlas;
+	class BindlessTextureTable;
+	struct AtlasRegion;
+
+	struct SpriteVertex
+	{
+		glm::vec2 position;
+		glm::vec2 texCoord;
+
+		// RGBA8, normalized by the layout
+		uint32_t color;
+
+		float textureSlot;
+	};
+
+	// Writes textured quads straight into a streaming vertex buffer and draws
+	// them in as few calls as possible, one per group of 16 textures
+	//
+	// With a bindless table textures are never bound, sprites only break
+	// the batch when the vertex block is full, the shader must then be the
+	// BINDLESS variant of Sprite.shader, and TEXTURE_ARRAY for array layers
+	class SpriteBatch
+	{
+
+	public:
+
+		// Texture units guaranteed by an OpenGL 3.3 fragment shader
+		static const unsigned int MAX_TEXTURE_SLOTS = 16;
+
+	private:
+
+		unsigned int maxSprites;
+		unsigned int spriteCount;
+
+		// Sprites that fit in the block being written
+		unsigned int spriteCapacity;
+		SpriteVertex* vertices;
+
+		Texture* textureSlots[MAX_TEXTURE_SLOTS];
+		unsigned int textureCount;
+
+		// Array whose layers the sprites of the batch use, null for 2D textures
+		TextureArray* textureArray;
+
+		// Null unless textures are sampled through bindless handles
+		BindlessTextureTable* bindlessTable;
+
+		// Sprites dropped because the table was full, reported once per table
+		bool bindlessFullReported;
+
+		VertexArray vertexArray;
+		StreamingBuffer vertexBuffer;
+
+		// Indices of every quad are the same, computed once
+		std::unique_ptr<IndexBuffer> indexBuffer;
+
+		Shader& shader;
+
+		// Sampler array is set once the shader is ready
+		bool samplersSet;
+
+		unsigned int drawCalls;
+
+	public:
+
+		// Shader must follow the layout of Sprite.shader
+		SpriteBatch(Shader& spriteShader, unsigned int maxSpritesPerDraw = 10000);
+
+		SpriteBatch(const SpriteBatch&) = delete;
+		SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+	public:
+
+		void begin(const glm::mat4& viewProjection);
+
+		// uvRect holds (u0, v0, u1, v1)
+		void draw(Texture& texture, glm::vec2 position, glm::vec2 size,
+			glm::vec4 color = glm::vec4(1.0f), glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+		// Image of an atlas, every region of it shares one texture slot
+		void draw(TextureAtlas& atlas, const AtlasRegion& region, glm::vec2 position, glm::vec2 size,
+			glm::vec4 color = glm::vec4(1.0f));
+
+		// Layer of an array, sprites of the same array share one draw
+		void draw(TextureArray& array, unsigned int layer, glm::vec2 position, glm::vec2 size,
+			glm::vec4 color = glm::vec4(1.0f), glm::vec4 uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+		// Textures of later draws are added to the table instead of taking a
+		// slot, the table is uploaded before each draw, null goes back to slots
+		void setBindlessTable(BindlessTextureTable* table);
+
+		// Once per frame, the vertex ring moves to its next region
+		void end();
+
+		// Draw calls issued since last begin
+		unsigned int getDrawCalls() const { return drawCalls; }
+
+	private:
+
+		void flush();
+
+		void writeQuad(glm::vec2 position, glm::vec2 size, glm::vec4 color, glm::vec4 uvRect, float textureSlot);
+	};
+}
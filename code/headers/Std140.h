@@ -0,0 +1,111 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <glm/glm.hpp>
+
+namespace mg
+{
+	// Base alignment and size of a member of a std140 uniform block
+	// Types without a specialization can not be used in a block
+	template<typename T>
+	struct Std140Traits;
+
+	template<> struct Std140Traits<float>        { static constexpr size_t alignment =  4; static constexpr size_t size =  4; };
+	template<> struct Std140Traits<int>          { static constexpr size_t alignment =  4; static constexpr size_t size =  4; };
+	template<> struct Std140Traits<unsigned int> { static constexpr size_t alignment =  4; static constexpr size_t size =  4; };
+	template<> struct Std140Traits<glm::vec2>    { static constexpr size_t alignment =  8; static constexpr size_t size =  8; };
+	template<> struct Std140Traits<glm::vec3>    { static constexpr size_t alignment = 16; static constexpr size_t size = 12; };
+	template<> struct Std140Traits<glm::vec4>    { static constexpr size_t alignment = 16; static constexpr size_t size = 16; };
+	template<> struct Std140Traits<glm::ivec4>   { static constexpr size_t alignment = 16; static constexpr size_t size = 16; };
+	template<> struct Std140Traits<glm::mat4>    { static constexpr size_t alignment = 16; static constexpr size_t size = 64; };
+
+	constexpr size_t std140Align(size_t offset, size_t alignment)
+	{
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	// Offsets of the members of a uniform block, in declaration order,
+	// computed at compile time with the std140 rules
+	//
+	// using FrameLayout = Std140Layout<glm::mat4, float>;
+	// FrameLayout::offset<1>() == 64, FrameLayout::size == 80
+	template<typename... Members>
+	class Std140Layout
+	{
+
+	public:
+
+		static constexpr size_t count = sizeof...(Members);
+
+		template<size_t I>
+		using Type = std::tuple_element_t<I, std::tuple<Members...>>;
+
+	private:
+
+		static constexpr std::array<size_t, count + 1> computeOffsets()
+		{
+			const size_t alignments[] = { Std140Traits<Members>::alignment... };
+			const size_t sizes[]      = { Std140Traits<Members>::size... };
+
+			std::array<size_t, count + 1> result = {};
+			size_t offset = 0;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				offset = std140Align(offset, alignments[i]);
+				result[i] = offset;
+				offset += sizes[i];
+			}
+
+			// Block size is rounded up to the alignment of a vec4
+			result[count] = std140Align(offset, 16);
+
+			return result;
+		}
+
+		static constexpr std::array<size_t, count + 1> offsets = computeOffsets();
+
+	public:
+
+		static constexpr size_t size = offsets[count];
+
+		template<size_t I>
+		static constexpr size_t offset()
+		{
+			static_assert(I < count, "Member index out of range");
+			return offsets[I];
+		}
+	};
+
+	// CPU copy of a uniform block laid out as the GPU expects it
+	template<typename Layout>
+	class UniformBlock
+	{
+
+	private:
+
+		alignas(16) unsigned char data[Layout::size];
+
+	public:
+
+		UniformBlock() : data()
+		{ }
+
+		template<size_t I>
+		void set(const typename Layout::template Type<I>& value)
+		{
+			std::memcpy(data + Layout::template offset<I>(), &value, Std140Traits<typename Layout::template Type<I>>::size);
+		}
+
+		const void* getData() const { return data; }
+		static constexpr size_t getSize() { return Layout::size; }
+	};
+}
@@ -0,0 +1,83 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace mg
+{
+	// Ring of buffer regions written by the CPU while the GPU reads the
+	// previous ones, each region is guarded by a fence so it is only
+	// rewritten once the draws reading it are done
+	//
+	// With buffer storage the ring is mapped once (persistent, coherent) and
+	// writes go straight to it, otherwise writes land in a CPU copy uploaded
+	// with glBufferSubData and the storage is orphaned when the ring wraps
+	class StreamingBuffer
+	{
+
+	public:
+
+		static const unsigned int MAX_REGIONS = 4;
+
+	private:
+
+		unsigned int id;
+		unsigned int target;
+
+		size_t regionSize;
+		unsigned int regionCount;
+
+		// Region being written and write position inside it
+		unsigned int region;
+		size_t regionOffset;
+
+		// Offset of the block handed out by last map
+		size_t mappedOffset;
+
+		bool persistent;
+		unsigned char* mappedData;
+		std::vector<unsigned char> stagingData;
+
+		GLsync fences[MAX_REGIONS];
+
+	public:
+
+		StreamingBuffer(unsigned int bufferTarget, size_t bytesPerRegion, unsigned int regions = 3);
+	   ~StreamingBuffer();
+
+		StreamingBuffer(const StreamingBuffer&) = delete;
+		StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+	public:
+
+		void bind();
+		void unbind();
+
+		// Pointer to write at least minSize bytes aligned to alignment (relative
+		// to the buffer start), available receives how many bytes can be written.
+		// Moves to the next region when the current one can not fit minSize
+		void* map(size_t minSize, size_t alignment, size_t& available);
+
+		// Publish usedSize bytes written since map, returns their offset in the buffer
+		size_t unmap(size_t usedSize);
+
+		// Fence the region written this frame and move to the next one
+		void endFrame();
+
+		unsigned int getId() const { return id; }
+		size_t getRegionSize() const { return regionSize; }
+		bool isPersistent() const { return persistent; }
+
+	private:
+
+		void nextRegion();
+		void waitRegion(unsigned int index);
+	};
+}
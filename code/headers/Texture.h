@@ -6,9 +6,53 @@
 #pragma once
 
 #include "Renderer.h"
+#include "CompressedImage.h"
 
 namespace mg
 {
+	enum class TextureFilter
+	{
+		NEAREST, LINEAR
+	};
+
+	enum class TextureWrap
+	{
+		CLAMP_TO_EDGE, REPEAT, MIRRORED_REPEAT
+	};
+
+	enum class MipmapMode
+	{
+		// Level 0 only
+		NONE,
+		// glGenerateMipmap once level 0 is uploaded
+		GPU,
+		// Box filtered on the CPU, e.g. on a loader thread
+		CPU
+	};
+
+	// How a texture is stored and sampled, the default is a single level
+	// with bilinear filtering clamped to the edges
+	struct TextureDescriptor
+	{
+		TextureFilter minFilter = TextureFilter::LINEAR;
+		TextureFilter magFilter = TextureFilter::LINEAR;
+
+		// Blend between levels, LINEAR with LINEAR filters is trilinear
+		TextureFilter mipFilter = TextureFilter::LINEAR;
+
+		TextureWrap wrapS = TextureWrap::CLAMP_TO_EDGE;
+		TextureWrap wrapT = TextureWrap::CLAMP_TO_EDGE;
+
+		MipmapMode mipmaps = MipmapMode::NONE;
+
+		// Samples along the axis of anisotropy, clamped to what the driver supports
+		float anisotropy = 1.0f;
+
+		// Last row first the way OpenGL expects, false skips the flip when
+		// loading files and leaves flipping v to the texture coordinates
+		bool flipVertically = true;
+	};
+
 	class Texture
 	{
 
@@ -22,15 +66,66 @@ namespace mg
 		int height;
 		int bitsPerPixel;
 
+		// 1 to 4 channels of 8 bits, stored as R8, RG8, RGB8 or RGBA8
+		int channels;
+
+		TextureDescriptor descriptor;
+		unsigned int mipLevels;
+
 	public:
 
-		Texture(const std::string& path);
+		// DDS and KTX2 files are uploaded as they are, other images are decoded
+		// keeping the channels of the file, grey ones sample as (l, l, l, a)
+		//
+		// Files that fail to load give a 1x1 magenta texture
+		Texture(const std::string& path, const TextureDescriptor& textureDescriptor = TextureDescriptor());
+
+		// Every level of image, mipmaps of the descriptor are not generated for
+		// compressed formats, formats the driver lacks are decoded when possible
+		//
+		// Path of the file it came from, only used in messages
+		Texture(const CompressedImage& image, const std::string& path, const TextureDescriptor& textureDescriptor = TextureDescriptor());
+
+		// RGBA8 texture, pixels may be null to fill it later with setRows,
+		// mipmaps are then left to the caller
+		Texture(int textureWidth, int textureHeight, const unsigned char* pixels = nullptr,
+			const TextureDescriptor& textureDescriptor = TextureDescriptor());
+
+		// Same with 1 to 4 channels, rows of pixels are not padded
+		Texture(int textureWidth, int textureHeight, int pixelChannels, const unsigned char* pixels,
+			const TextureDescriptor& textureDescriptor = TextureDescriptor());
 	   ~Texture();
 
 		void bind(unsigned slot = 0);
 		void unbind();
 
+		// Replace rowCount full rows starting at firstRow with pixels of the
+		// channels of the texture, an offset into the buffer when a pixel
+		// unpack buffer is bound
+		void setRows(int firstRow, int rowCount, const void* pixels, unsigned int level = 0);
+
+		// Fill every level below 0 from level 0 with glGenerateMipmap
+		void generateMipmaps();
+
+		// Fill every level below 0 from chain, as made by buildMipChain
+		void setMipChain(const void* chain);
+
 		int getWidth () const { return  width; }
 		int getHeight() const { return height; }
+		int getChannels() const { return channels; }
+
+		unsigned int getId() const { return id; }
+
+		const TextureDescriptor& getDescriptor() const { return descriptor; }
+		unsigned int getMipLevels() const { return mipLevels; }
+
+	private:
+
+		void create(const unsigned char* pixels);
+		void createCompressed(const CompressedImage& image);
 	};
+
+	// Filters, wrap modes and anisotropy of the descriptor on the texture
+	// bound to target, mipmap filtering only with more than one level
+	void applyTextureSampling(unsigned int target, const TextureDescriptor& descriptor, unsigned int mipLevels);
 }
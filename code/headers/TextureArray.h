@@ -0,0 +1,62 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <string>
+
+#include "Texture.h"
+
+namespace mg
+{
+	// Layers of the same size and format in one GL_TEXTURE_2D_ARRAY, a
+	// single bind makes every layer available to a shader, which picks one
+	// with the third texture coordinate
+	class TextureArray
+	{
+
+	private:
+
+		unsigned int id;
+
+		int width;
+		int height;
+		unsigned int layerCount;
+
+		TextureDescriptor descriptor;
+		unsigned int mipLevels;
+
+	public:
+
+		// Every layer starts undefined, fill them with setLayer
+		TextureArray(int layerWidth, int layerHeight, unsigned int layers,
+			const TextureDescriptor& textureDescriptor = TextureDescriptor());
+	   ~TextureArray();
+
+		TextureArray(const TextureArray&) = delete;
+		TextureArray& operator=(const TextureArray&) = delete;
+
+	public:
+
+		void bind(unsigned slot = 0);
+		void unbind();
+
+		// Replace a layer with RGBA8 pixels, last row first, mipmaps of the
+		// descriptor are built for that layer only
+		void setLayer(unsigned int layer, const unsigned char* pixels);
+
+		// Decode a file into a layer, false if it fails or has another size
+		bool loadLayer(unsigned int layer, const std::string& path);
+
+		int getWidth () const { return  width; }
+		int getHeight() const { return height; }
+
+		unsigned int getLayerCount() const { return layerCount; }
+		unsigned int getId() const { return id; }
+
+		const TextureDescriptor& getDescriptor() const { return descriptor; }
+		unsigned int getMipLevels() const { return mipLevels; }
+	};
+}
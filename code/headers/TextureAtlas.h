@@ -0,0 +1,66 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Hash.h"
+#include "Texture.h"
+#include "AtlasPacker.h"
+
+namespace mg
+{
+	// Texture holding many images, sprites and meshes sharing it draw
+	// without binding a texture in between
+	class TextureAtlas
+	{
+
+	private:
+
+		std::unique_ptr<Texture> texture;
+
+		std::vector<std::string> names;
+		std::vector<AtlasRegion> regions;
+
+		// Name hash to index in regions, names sharing a hash get an entry each
+		std::unordered_multimap<uint32_t, size_t, IdentityHash> regionIndices;
+
+	public:
+
+		// Atlas built at runtime
+		TextureAtlas(const AtlasLayout& layout, const TextureDescriptor& descriptor = TextureDescriptor());
+
+		// Image and table written by TextureTool atlas, the image may have
+		// been compressed since
+		TextureAtlas(const std::string& imagePath, const std::string& tablePath, const TextureDescriptor& descriptor = TextureDescriptor());
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+	public:
+
+		// Null when there is no image with that name, look regions up once
+		// rather than every frame
+		const AtlasRegion* find(const std::string& name) const;
+
+		Texture& getTexture() { return *texture; }
+
+		const std::vector<std::string>& getNames() const { return names; }
+		const std::vector<AtlasRegion>& getRegions() const { return regions; }
+
+	private:
+
+		void indexRegions();
+	};
+
+	// Move the texture coordinates of mesh vertices into a region, so the
+	// mesh can be drawn with the atlas texture
+	void remapTexCoords(void* vertices, unsigned int vertexCount, unsigned int stride, unsigned int texCoordOffset, const AtlasRegion& region);
+}
@@ -0,0 +1,141 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Texture.h"
+#include "ImageDecoder.h"
+#include "StreamingBuffer.h"
+
+namespace mg
+{
+	// Texture requested from a TextureLoader, resolves to a placeholder
+	// until the file is decoded and uploaded
+	struct TextureHandle
+	{
+		int slot;
+
+		explicit TextureHandle(int textureSlot = -1) : slot(textureSlot)
+		{ }
+
+		bool isValid() const { return slot != -1; }
+	};
+
+	enum class TextureLoadState
+	{
+		DECODING, UPLOADING, LOADED, FAILED
+	};
+
+	// Loads textures without blocking the render loop
+	//
+	// Files are decoded by a pool of worker threads, decoded images are
+	// copied to pixel buffer objects and uploaded a few rows at a time
+	// with no more than the upload budget per frame, so a level asking
+	// for hundreds of textures spreads the cost over several frames
+	//
+	// Compressed containers are uploaded whole in a single frame, straight
+	// from memory, their size still counts against the budget
+	class TextureLoader
+	{
+
+	private:
+
+		struct Entry
+		{
+			std::string path;
+			TextureDescriptor descriptor;
+			TextureLoadState state;
+
+			// Null until the upload starts
+			std::unique_ptr<Texture> texture;
+		};
+
+		// Decoded by a worker, waiting for upload
+		struct Image
+		{
+			int slot;
+
+			// Channels of the file, uploaded without expanding them to RGBA
+			DecodedImage pixels;
+
+			// Rows already uploaded
+			int uploadedRows;
+
+			// Levels below 0 when mipmaps are built on the CPU
+			std::vector<unsigned char> mipChain;
+
+			// Set instead of pixels for DDS and KTX2 files
+			std::unique_ptr<CompressedImage> compressed;
+		};
+
+		struct Job
+		{
+			int slot;
+			std::string path;
+			MipmapMode mipmaps;
+			bool flipped;
+		};
+
+		// Render thread only
+		std::vector<Entry> entries;
+		Texture placeholder;
+
+		// Ring of pixel unpack buffers, one region per frame
+		StreamingBuffer uploadBuffer;
+		size_t uploadBudget;
+
+		// Shared with the workers
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable imageTaken;
+
+		std::deque<Job> jobs;
+		std::deque<Image> decoded;
+
+		// Decoded images waiting at most, bounds memory of large requests
+		size_t maxDecoded;
+		bool stopping;
+
+		std::vector<std::thread> workers;
+
+	public:
+
+		// Thread count 0 uses every core but the one of the render thread
+		TextureLoader(size_t bytesPerFrame = 4 * 1024 * 1024, unsigned int threadCount = 0);
+	   ~TextureLoader();
+
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+
+	public:
+
+		// Queue a file for decoding, returns immediately
+		// CPU mipmaps are built by the worker that decodes the file
+		TextureHandle load(const std::string& path, const TextureDescriptor& descriptor = TextureDescriptor());
+
+		// Upload decoded images within the budget, call once per frame
+		void update();
+
+		// The texture once loaded, the placeholder before or if loading failed
+		Texture& get(TextureHandle handle);
+
+		TextureLoadState getState(TextureHandle handle) const { return entries[handle.slot].state; }
+
+		// Textures not loaded nor failed yet
+		size_t getPendingCount() const;
+
+	private:
+
+		void work();
+	};
+}
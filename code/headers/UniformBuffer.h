@@ -0,0 +1,64 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Std140.h"
+
+namespace mg
+{
+	// Uniform block shared by every program that declares it, bound once
+	// to a binding point and updated with a single upload
+	//
+	// Programs linked after the buffer is created get their block with the
+	// same name attached to the binding point automatically
+	class UniformBuffer
+	{
+
+	private:
+
+		struct BlockBinding
+		{
+			std::string name;
+			unsigned int binding;
+		};
+
+		// Blocks known to every shader linked from now on
+		static std::vector<BlockBinding> registeredBlocks;
+
+		unsigned int id;
+		unsigned int binding;
+		size_t size;
+
+		std::string blockName;
+
+	public:
+
+		UniformBuffer(const std::string& name, size_t blockSize, unsigned int bindingPoint);
+	   ~UniformBuffer();
+
+		UniformBuffer(const UniformBuffer&) = delete;
+		UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	public:
+
+		void setData(const void* data, size_t dataSize, size_t offset = 0);
+
+		template<typename Layout>
+		void setData(const UniformBlock<Layout>& block)
+		{
+			setData(block.getData(), block.getSize());
+		}
+
+		unsigned int getBinding() const { return binding; }
+		size_t getSize() const { return size; }
+
+		// Attach blocks of a program to the binding points of the registered buffers
+		static void bindBlocks(unsigned int program);
+	};
+}
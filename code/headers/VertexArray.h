@@ -6,6 +6,7 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "StreamingBuffer.h"
 #include "VertexBufferLayout.h"
 
 namespace mg
@@ -17,14 +18,30 @@ namespace mg
 
 		unsigned int id;
 
+		// Next free attribute location, buffers added later continue from here
+		unsigned int attributeCount;
+
 	public:
 
 		VertexArray();
 	   ~VertexArray();
 
+	   // Can be called once per buffer, e.g. per vertex data plus per instance data
 	   void addBuffer(VertexBuffer& vb, const VertexBufferLayout& layout);
 
+	   // Attributes start at the beginning of the ring, select the region
+	   // being drawn with the base vertex of the draw call
+	   void addBuffer(StreamingBuffer& sb, const VertexBufferLayout& layout);
+
 	   void bind();
 	   void unbind();
+
+	   unsigned int getId() const { return id; }
+	   unsigned int getAttributeCount() const { return attributeCount; }
+
+	private:
+
+	   // Point attributes to the buffer bound to GL_ARRAY_BUFFER
+	   void addAttributes(const VertexBufferLayout& layout);
 	};
 }
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 namespace mg
 {
 	class VertexBuffer
@@ -15,15 +17,27 @@ namespace mg
 		// ID of vertex buffer given by OpenGL
 		unsigned int id;
 
+		size_t size;
+
 	public:
 
 		VertexBuffer(const void* data, size_t size);
+
+		// Empty buffer meant to be filled every frame with setData
+		VertexBuffer(size_t size);
 	   ~VertexBuffer();
 
 	public:
 
 		void bind();
 		void unbind();
+
+		void setData(const void* data, size_t dataSize, size_t offset = 0);
+
+		// Detach previous storage so a rewrite does not wait for pending draws
+		void orphan();
+
+		size_t getSize() const { return size; }
 	};
 }
 
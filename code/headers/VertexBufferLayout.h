@@ -19,10 +19,14 @@ namespace mg
 		unsigned int count;
 		unsigned char normalized;
 
-		VertexBufferElement(unsigned int _type, unsigned int _count, unsigned char _normalized) :
+		// Instances drawn before the attribute advances, 0 means per vertex
+		unsigned int divisor;
+
+		VertexBufferElement(unsigned int _type, unsigned int _count, unsigned char _normalized, unsigned int _divisor = 0) :
 			type(_type),
 			count(_count),
-			normalized(_normalized)
+			normalized(_normalized),
+			divisor(_divisor)
 		{ }
 
 		static unsigned int GetSizeOfType(unsigned int type)
@@ -58,32 +62,34 @@ namespace mg
 		const std::vector<VertexBufferElement>& getElements() const { return elements; }
 		const unsigned int getStride() const { return stride; }
 
+		// Divisor 0 advances attribute per vertex, N advances it every N instances
+		// Counts above 4 (e.g. 16 floats for a mat4) take one location per 4 components
 		template<typename T>
-		void push(unsigned int count)
+		void push(unsigned int count, unsigned int divisor = 0)
 		{
 			assert(false);
 		}
+	};
 
-		// Template specializations
-		template<>
-		void push<float>(unsigned int count)
-		{
-			elements.push_back(VertexBufferElement(GL_FLOAT, count, GL_FALSE));
-			stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
-		}
+	// Template specializations
+	template<>
+	inline void VertexBufferLayout::push<float>(unsigned int count, unsigned int divisor)
+	{
+		elements.push_back(VertexBufferElement(GL_FLOAT, count, GL_FALSE, divisor));
+		stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
+	}
 
-		template<>
-		void push<unsigned int>(unsigned int count)
-		{
-			elements.push_back(VertexBufferElement(GL_UNSIGNED_INT, count, GL_FALSE));
-			stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
-		}
+	template<>
+	inline void VertexBufferLayout::push<unsigned int>(unsigned int count, unsigned int divisor)
+	{
+		elements.push_back(VertexBufferElement(GL_UNSIGNED_INT, count, GL_FALSE, divisor));
+		stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
+	}
 
-		template<>
-		void push<unsigned char>(unsigned int count)
-		{
-			elements.push_back(VertexBufferElement(GL_UNSIGNED_BYTE, count, GL_TRUE));
-			stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
-		}
-	};
+	template<>
+	inline void VertexBufferLayout::push<unsigned char>(unsigned int count, unsigned int divisor)
+	{
+		elements.push_back(VertexBufferElement(GL_UNSIGNED_BYTE, count, GL_TRUE, divisor));
+		stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
+	}
 }
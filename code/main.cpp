@@ -9,35 +9,132 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
-#include <thread>
-#include <chrono>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 
 #include "Shader.h"
 #include "Texture.h"
+#include "TextureLoader.h"
 #include "Renderer.h"
+#include "GLStateCache.h"
+#include "GLExtensions.h"
 #include "VertexArray.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
+#include "UniformBuffer.h"
+#include "ShaderCache.h"
+#include "ShaderWatcher.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "GPUProfiler.h"
+#include "RenderStats.h"
+#include "HeadlessContext.h"
+#include "FrameBuffer.h"
+#include "ImageWriter.h"
 
 using namespace sf;
 using namespace mg;
 
-using namespace std::chrono;
+// Layout of the FrameData block declared by the shaders
+using FrameLayout = Std140Layout<glm::mat4, float>;
+
+enum FrameMember
+{
+    VIEW_PROJECTION, TIME
+};
+
+struct Options
+{
+    // Render offscreen without a window, for benchmarks and image tests
+    bool headless = false;
+
+    // Frames to render before exiting, 0 runs until the window is closed
+    int frames = 0;
+
+    // Directory to write every frame to as a PNG, headless only
+    std::string dumpDirectory;
+};
+
+static void printUsage()
+{
+    std::cout << "Usage: MGLearnOpenGL [--headless --frames N [--dump <directory>]] [--frames N]" << std::endl;
+}
 
-int main()
+static bool parseOptions(int argc, char** argv, Options& options)
 {
-    // Window with OpenGL context
-    Window window(VideoMode(960, 540), "MGLearnOpenGL", Style::Default, ContextSettings(24, 0, 0, 3, 3, ContextSettings::Core));
+    for (int i = 1; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if (option == "--headless")
+            options.headless = true;
+        else if (option == "--frames" && i + 1 < argc)
+            options.frames = std::atoi(argv[++i]);
+        else if (option == "--dump" && i + 1 < argc)
+            options.dumpDirectory = argv[++i];
+        else
+            return false;
+    }
+
+    // A headless run has no window to close, it needs to know when to stop
+    if (options.headless && options.frames <= 0)
+        return false;
+
+    return options.dumpDirectory.empty() || options.headless;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    Profiler::setThreadName("Main");
+
+    const int width = 960;
+    const int height = 540;
+
+    // Window with OpenGL context, or a context alone when running headless
+    std::unique_ptr<Window> window;
+    HeadlessContext headlessContext;
+
+    GLADloadproc getFunction = HeadlessContext::getFunction;
+
+    if (options.headless)
+    {
+        if (!headlessContext.create(3, 3))
+            return 1;
+    }
+    else
+    {
+        window = std::make_unique<Window>(VideoMode(width, height), "MGLearnOpenGL", Style::Default, ContextSettings(24, 0, 0, 3, 3, ContextSettings::Core));
+        getFunction = [](const char* name) { return (void*)Context::getFunction(name); };
+    }
 
     // Glad initialization
-    GLenum glad_init = gladLoadGL();
+    GLenum glad_init = options.headless ? gladLoadGLLoader(getFunction) : gladLoadGL();
 
     // Stop program if glad could not load properly
     assert(glad_init != 0);
 
+    // Load entry points newer than what glad was generated for
+    GLExtensions::load(getFunction);
+
+    // Start state cache from whatever the context creation left bound
+    GLStateCache::invalidate();
+
     std::cout << glGetString(GL_VERSION) << std::endl;
 
     glEnable(GL_BLEND);
@@ -76,17 +173,40 @@ int main()
     // 4/3 projection matrix
     glm::mat4 projection = glm::ortho(0.f, 960.f, 0.f, 540.f, -1.0f, 1.0f);
 
+    // Linked programs are reused across runs
+    mg::ShaderCache shaderCache("../cache/shaders");
+    mg::Shader::setProgramCache(&shaderCache);
+
+    // Created before shaders so they attach their FrameData block to it when linked
+    mg::UniformBuffer frameBuffer("FrameData", FrameLayout::size, 0);
+    mg::UniformBlock<FrameLayout> frameData;
+
     mg::Shader shader("../code/shaders/Basic.shader");
+
+    // Catch attributes the vertex array does not feed before the first draw
+    shader.validateLayout(vertexBufferLayout);
     shader.bind();
     shader.setUniform4f("u_Color", glm::vec4(1.0f, 0.0f, 1.0f, 1.0f));
-    shader.setUniformMat4f("modelViewProjection", projection);
 
-    mg::Texture texture("../resources/textures/ciri.jpg");
-    texture.bind();
+    // Decoded in the background, a placeholder is drawn until it is uploaded
+    mg::TextureLoader textureLoader;
+    // Drawn smaller than its size, trilinear filtering over a mip chain built by the loader threads
+    mg::TextureDescriptor textureDescriptor;
+    textureDescriptor.mipmaps = mg::MipmapMode::CPU;
+    textureDescriptor.anisotropy = 8.0f;
+
+    mg::TextureHandle texture = textureLoader.load("../resources/textures/ciri.jpg", textureDescriptor);
     shader.setUniform1i("u_Texture", 0);
 
     glClearColor(0.1f, 0.1f, 0.1f, 1);
 
+    // Resolved once, the frame loop does no name lookup
+    UniformHandle colorUniform = shader.uniform("u_Color");
+
+    // Edits to the shader files show up without restarting
+    mg::ShaderWatcher shaderWatcher;
+    shaderWatcher.watch(shader);
+
     float redChannel = 0.0f;
     float increment = 0.05f;
 
@@ -96,23 +216,51 @@ int main()
     vertexBuffer.unbind();
     indexBuffer.unbind();
 
-    // Delta time variables
-    auto  chrono = high_resolution_clock();
-    float target_time = 1.f / 60;
-    float delta_time = target_time;
+    // Waits for the refresh, CAPPED paces frames itself without vsync,
+    // headless runs go as fast as they can
+    mg::FramePacer framePacer(options.headless ? mg::FramePacing::UNCAPPED : mg::FramePacing::VSYNC, 60.0f);
+
+    if (window)
+        window->setVerticalSyncEnabled(framePacer.getMode() == mg::FramePacing::VSYNC);
 
-    window.setVerticalSyncEnabled(true);
+    // Without a window frames are drawn into a target of the same size
+    std::unique_ptr<mg::FrameBuffer> offscreenTarget;
+    std::vector<unsigned char> framePixels;
+
+    if (options.headless)
+    {
+        offscreenTarget = std::make_unique<mg::FrameBuffer>(width, height);
+
+        if (!offscreenTarget->isComplete())
+            return 1;
+
+        offscreenTarget->bind();
+
+        if (!options.dumpDirectory.empty())
+            std::filesystem::create_directories(options.dumpDirectory);
+
+        // Same image in every run, dumps never show the placeholder
+        while (textureLoader.getPendingCount() > 0)
+        {
+            textureLoader.update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // Renderer sections report GPU time to it, read back a few frames later
+    mg::GPUProfiler gpuProfiler;
 
     bool running = true;
+    float time = 0.0f;
+    int frame = 0;
+
+    auto runStart = std::chrono::steady_clock::now();
 
     do
     {
-        // Get time where frame started
-        high_resolution_clock::time_point start = chrono.now();
-
         Event event;
 
-        while (window.pollEvent(event))
+        while (window && window->pollEvent(event))
         {
             switch (event.type)
             {
@@ -121,13 +269,49 @@ int main()
                     running = false;
                     break;
                 }
+                // Open the capture in chrome://tracing or ui.perfetto.dev
+                case Event::KeyPressed:
+                {
+                    if (event.key.code == Keyboard::F11 && Profiler::captureFrames(120, "../profiles/capture.json"))
+                        std::cout << "Capturing 120 frames..." << std::endl;
+
+                    // A GPU time close to the frame time means the frame is GPU bound
+                    if (event.key.code == Keyboard::F10)
+                    {
+                        std::cout << "Frame " << framePacer.getRawDeltaTime() * 1000.0f << " ms, " << gpuProfiler.getSummary() << std::endl;
+
+                        for (int stat = 0; stat < (int)RenderStat::COUNT; stat++)
+                        {
+                            StatSummary summary = RenderStats::summarize((RenderStat)stat);
+
+                            std::cout << RenderStats::getName((RenderStat)stat) << ": min " << summary.min << ", avg " << summary.average
+                                << ", p99 " << summary.p99 << ", max " << summary.max << std::endl;
+                        }
+                    }
+                    break;
+                }
             }
         }
 
+        gpuProfiler.beginFrame();
+
+        // Swap in programs of edited shader files
+        shaderWatcher.update();
+
+        // One upload for every program using the block
+        frameData.set<VIEW_PROJECTION>(projection);
+        frameData.set<TIME>(time);
+        frameBuffer.setData(frameData);
+
+        // Upload what the workers decoded within the frame budget
+        textureLoader.update();
+
         renderer.clear();
 
+        textureLoader.get(texture).bind();
+
         shader.bind(); 
-        shader.setUniform4f("u_Color", glm::vec4(redChannel, 0.0f, 1.0f, 1.0f));
+        shader.setUniform4f(colorUniform, glm::vec4(redChannel, 0.0f, 1.0f, 1.0f));
 
         renderer.draw(vertexArray, indexBuffer, shader);
 
@@ -138,19 +322,49 @@ int main()
 
         redChannel += increment;
 
-        window.display();
-
-        // Compute delta time
-        float elapsed = duration<float>(chrono.now() - start).count();
+        gpuProfiler.endFrame();
+        RenderStats::endFrame();
 
-        if (elapsed < target_time)
+        if (window)
         {
-            std::this_thread::sleep_for(duration<float>(target_time - elapsed));
+            ProfileScope profile("Window::display");
+            window->display();
+        }
+        else if (!options.dumpDirectory.empty())
+        {
+            ProfileScope profile("FrameBuffer::readPixels");
+            offscreenTarget->readPixels(framePixels);
+
+            std::string number = std::to_string(frame);
+            std::string path = options.dumpDirectory + "/frame_" + std::string(4 - std::min<size_t>(number.size(), 4), '0') + number + ".png";
+
+            if (!mg::writePNG(path, framePixels.data(), width, height, true))
+                running = false;
         }
 
-        delta_time = duration<float>(chrono.now() - start).count();
+        // Wait for the next frame and measure this one
+        framePacer.endFrame();
+
+        // Fixed steps headless, frame N looks the same in every run
+        time += options.headless ? 1.0f / 60.0f : framePacer.getDeltaTime();
+
+        Profiler::frameMark();
+
+        if (options.frames > 0 && ++frame == options.frames)
+            running = false;
 
     } while (running);
 
+    if (options.headless)
+    {
+        // Draws are queued, the time is only known once the GPU is done
+        glFinish();
+
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - runStart).count();
+
+        std::cout << "Rendered " << frame << " frames in " << milliseconds << " ms, " << milliseconds / frame << " ms per frame" << std::endl;
+        std::cout << gpuProfiler.getSummary() << std::endl;
+    }
+
     return 0;
 }
\ No newline at end of file
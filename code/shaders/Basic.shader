@@ -11,12 +11,12 @@ layout(location = 1) in vec2 texCoord;
 
 out vec2 v_TexCoord;
 
-uniform mat4 modelViewProjection;
+#include "FrameData.glsl"
 
 void main()
 {
     v_TexCoord = texCoord;
-    gl_Position = modelViewProjection * position;
+    gl_Position = viewProjection * position;
 }
 
 #shader fragment
@@ -0,0 +1,18 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+// Handles of a BindlessTextureTable, the stage must enable
+// GL_ARB_bindless_texture right after #version
+layout(std140) uniform BindlessTextures
+{
+    // Two 64 bit handles per element, 1024 in total
+    uvec4 bindlessHandles[512];
+};
+
+sampler2D getBindlessTexture(int index)
+{
+    uvec4 pair = bindlessHandles[index >> 1];
+    return sampler2D((index & 1) == 0 ? pair.xy : pair.zw);
+}
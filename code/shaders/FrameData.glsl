@@ -0,0 +1,11 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+// Shared by every program, bound to binding point 0
+layout(std140) uniform FrameData
+{
+    mat4 viewProjection;
+    float time;
+};
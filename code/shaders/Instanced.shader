@@ -0,0 +1,42 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#shader vertex
+#version 330 core
+
+// Per vertex
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+// Per instance, model takes locations 2 to 5
+layout(location = 2) in mat4 model;
+layout(location = 6) in vec4 instanceColor;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+#include "FrameData.glsl"
+
+void main()
+{
+    v_TexCoord = texCoord;
+    v_Color = instanceColor;
+    gl_Position = viewProjection * model * position;
+}
+
+#shader fragment
+#version 330 core
+
+out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main()
+{
+    color = texture(u_Texture, v_TexCoord) * v_Color;
+}
@@ -0,0 +1,82 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+layout(location = 3) in float textureSlot;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+flat out int v_TextureSlot;
+
+uniform mat4 modelViewProjection;
+
+void main()
+{
+    v_TexCoord = texCoord;
+    v_Color = color;
+    v_TextureSlot = int(textureSlot);
+    gl_Position = modelViewProjection * position;
+}
+
+#shader fragment
+#version 330 core
+
+// BINDLESS samples the textures of a BindlessTextureTable by index,
+// TEXTURE_ARRAY the layers of one TextureArray, otherwise up to 16 units
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+#include "BindlessTextures.glsl"
+#endif
+
+out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+flat in int v_TextureSlot;
+
+#if defined(TEXTURE_ARRAY)
+uniform sampler2DArray u_TextureArray;
+#elif !defined(BINDLESS)
+uniform sampler2D u_Textures[16];
+#endif
+
+void main()
+{
+#if defined(BINDLESS)
+    vec4 texColor = texture(getBindlessTexture(v_TextureSlot), v_TexCoord);
+#elif defined(TEXTURE_ARRAY)
+    vec4 texColor = texture(u_TextureArray, vec3(v_TexCoord, v_TextureSlot));
+#else
+    // GLSL 330 only allows indexing sampler arrays with constant expressions
+    vec4 texColor = vec4(1.0);
+
+    switch (v_TextureSlot)
+    {
+        case  0: texColor = texture(u_Textures[ 0], v_TexCoord); break;
+        case  1: texColor = texture(u_Textures[ 1], v_TexCoord); break;
+        case  2: texColor = texture(u_Textures[ 2], v_TexCoord); break;
+        case  3: texColor = texture(u_Textures[ 3], v_TexCoord); break;
+        case  4: texColor = texture(u_Textures[ 4], v_TexCoord); break;
+        case  5: texColor = texture(u_Textures[ 5], v_TexCoord); break;
+        case  6: texColor = texture(u_Textures[ 6], v_TexCoord); break;
+        case  7: texColor = texture(u_Textures[ 7], v_TexCoord); break;
+        case  8: texColor = texture(u_Textures[ 8], v_TexCoord); break;
+        case  9: texColor = texture(u_Textures[ 9], v_TexCoord); break;
+        case 10: texColor = texture(u_Textures[10], v_TexCoord); break;
+        case 11: texColor = texture(u_Textures[11], v_TexCoord); break;
+        case 12: texColor = texture(u_Textures[12], v_TexCoord); break;
+        case 13: texColor = texture(u_Textures[13], v_TexCoord); break;
+        case 14: texColor = texture(u_Textures[14], v_TexCoord); break;
+        case 15: texColor = texture(u_Textures[15], v_TexCoord); break;
+    }
+#endif
+
+    color = texColor * v_Color;
+}
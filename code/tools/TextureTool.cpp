@@ -0,0 +1,297 @@
+
+// Distributed under MIT License
+// @miguelgutierrezruano
+// 2023
+
+// Offline texture compressor and atlas packer, runs on the CPU so it needs no GPU
+//
+// Usage: TextureTool compress <input> <output.dds|.ktx2> [--format bc1|bc3|bc7]
+//                             [--no-mipmaps] [--no-flip] [--verify]
+//        TextureTool atlas <output.png> <inputs...> [--size N] [--padding N] [--alignment N]
+//        TextureTool info <file.dds|.ktx2>
+//
+// Images are flipped on load like Texture does, so the compressed file
+// can be sampled with the same texture coordinates, --no-flip keeps rows
+// top first for other readers
+//
+// atlas writes the packed image and a table of regions next to it, with
+// the .atlas extension, the image can then be compressed like any other
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "other/stb_image.h"
+#include "AtlasPacker.h"
+#include "BlockCompression.h"
+#include "CompressedImage.h"
+#include "ImageDecoder.h"
+#include "ImageWriter.h"
+#include "Mipmap.h"
+
+using namespace std::chrono;
+
+static void printUsage()
+{
+    std::cout << "Usage: TextureTool compress <input> <output.dds|.ktx2> [--format bc1|bc3|bc7] [--no-mipmaps] [--no-flip] [--verify]" << std::endl;
+    std::cout << "       TextureTool atlas <output.png> <inputs...> [--size N] [--padding N] [--alignment N]" << std::endl;
+    std::cout << "       TextureTool info <file.dds|.ktx2>" << std::endl;
+}
+
+static bool parseFormat(const std::string& name, mg::CompressedFormat& format)
+{
+    if (name == "bc1")
+        format = mg::CompressedFormat::BC1;
+    else if (name == "bc3")
+        format = mg::CompressedFormat::BC3;
+    else if (name == "bc7")
+        format = mg::CompressedFormat::BC7;
+    else
+        return false;
+
+    return true;
+}
+
+static bool endsWith(const std::string& text, const std::string& suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Peak signal to noise ratio of the colour channels, or of every channel
+static double computePSNR(const unsigned char* reference, const unsigned char* decoded, size_t texelCount, int channels)
+{
+    double squaredError = 0.0;
+
+    for (size_t i = 0; i < texelCount; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            double difference = (double)reference[i * 4 + c] - decoded[i * 4 + c];
+            squaredError += difference * difference;
+        }
+    }
+
+    double meanSquaredError = squaredError / (texelCount * channels);
+
+    if (meanSquaredError == 0.0)
+        return INFINITY;
+
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+static int compress(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string input = argv[2];
+    std::string output = argv[3];
+
+    bool formatGiven = false;
+    bool mipmaps = true;
+    bool flip = true;
+    bool verify = false;
+
+    mg::CompressedFormat format = mg::CompressedFormat::BC1;
+
+    for (int i = 4; i < argc; i++)
+    {
+        std::string option = argv[i];
+
+        if (option == "--format" && i + 1 < argc)
+        {
+            if (!parseFormat(argv[++i], format))
+            {
+                std::cout << "Unknown format " << argv[i] << ", use bc1, bc3 or bc7" << std::endl;
+                return 1;
+            }
+
+            formatGiven = true;
+        }
+        else if (option == "--no-mipmaps")
+            mipmaps = false;
+        else if (option == "--no-flip")
+            flip = false;
+        else if (option == "--verify")
+            verify = true;
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Channels stored in the file pick the default format
+    int width, height, channels;
+    mg::DecodedImage image;
+
+    if (!stbi_info(input.c_str(), &width, &height, &channels) || !mg::decodeImage(input, image, 4, flip))
+    {
+        std::cout << "Failed to load " << input << "!" << std::endl;
+        return 1;
+    }
+
+    const unsigned char* pixels = image.pixels.get();
+
+    // Images without alpha fit in BC1 at half the size
+    if (!formatGiven)
+        format = channels == 4 ? mg::CompressedFormat::BC7 : mg::CompressedFormat::BC1;
+
+    unsigned int levelCount = mipmaps ? mg::getMipLevelCount(width, height) : 1;
+    std::vector<unsigned char> chain = mg::buildMipChain(pixels, width, height, levelCount);
+
+    mg::CompressedImage compressed;
+    compressed.format = format;
+    compressed.srgb = false;
+    compressed.width = width;
+    compressed.height = height;
+    compressed.bottomUp = flip;
+
+    auto start = steady_clock::now();
+
+    const unsigned char* levelPixels = pixels;
+    std::vector<unsigned char> levelData;
+
+    for (unsigned int level = 0; level < levelCount; level++)
+    {
+        int levelWidth = mg::getMipSize(width, level);
+        int levelHeight = mg::getMipSize(height, level);
+
+        mg::compressImage(levelPixels, levelWidth, levelHeight, format, levelData);
+        mg::addCompressedLevel(compressed, levelData, levelWidth, levelHeight);
+
+        levelPixels = level == 0 ? chain.data() : levelPixels + mg::getMipByteSize(width, height, level);
+    }
+
+    double milliseconds = duration<double, std::milli>(steady_clock::now() - start).count();
+
+    bool saved = endsWith(output, ".ktx2") ? mg::saveKTX2(output, compressed) : mg::saveDDS(output, compressed);
+
+    if (!saved)
+        return 1;
+
+    size_t uncompressedSize = mg::getMipByteSize(width, height, 0) + chain.size();
+
+    std::cout << input << ": " << width << "x" << height << ", " << channels << " channels, " << levelCount << " levels" << std::endl;
+    std::cout << mg::getFormatName(format) << ": " << compressed.data.size() << " bytes, RGBA8: " << uncompressedSize << " bytes, "
+        << (double)uncompressedSize / compressed.data.size() << "x smaller" << std::endl;
+    std::cout << "Encoded in " << milliseconds << " ms" << std::endl;
+
+    if (verify)
+    {
+        std::vector<unsigned char> decoded;
+        mg::decompressImage(compressed.getLevelData(0), width, height, format, decoded);
+
+        size_t texelCount = (size_t)width * height;
+
+        std::cout << "PSNR RGB: " << computePSNR(pixels, decoded.data(), texelCount, 3) << " dB" << std::endl;
+
+        if (channels == 4)
+            std::cout << "PSNR RGBA: " << computePSNR(pixels, decoded.data(), texelCount, 4) << " dB" << std::endl;
+    }
+
+    return 0;
+}
+
+static int atlas(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::filesystem::path output = argv[2];
+
+    mg::AtlasSettings settings;
+    mg::AtlasBuilder builder;
+
+    for (int i = 3; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if (argument == "--size" && i + 1 < argc)
+            settings.maxSize = std::atoi(argv[++i]);
+        else if (argument == "--padding" && i + 1 < argc)
+            settings.padding = std::atoi(argv[++i]);
+        else if (argument == "--alignment" && i + 1 < argc)
+            settings.alignment = std::atoi(argv[++i]);
+        // Images are named after their file, without the extension
+        else if (!builder.addFile(std::filesystem::path(argument).stem().string(), argument))
+            return 1;
+    }
+
+    mg::AtlasLayout layout;
+
+    if (!builder.build(settings, layout))
+        return 1;
+
+    std::filesystem::path table = output;
+    table.replace_extension(".atlas");
+
+    if (!mg::writePNG(output.string(), layout.pixels.data(), layout.width, layout.height, true) ||
+        !mg::saveAtlasTable(table.string(), layout))
+        return 1;
+
+    std::cout << "Wrote " << output.string() << " and " << table.string() << std::endl;
+
+    return 0;
+}
+
+static int info(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    mg::CompressedImage image;
+
+    if (!mg::loadCompressedImage(argv[2], image))
+        return 1;
+
+    std::cout << argv[2] << ": " << mg::getFormatName(image.format) << (image.srgb ? " sRGB" : "") << ", "
+        << image.width << "x" << image.height << ", " << image.data.size() << " bytes, "
+        << (image.bottomUp ? "bottom" : "top") << " row first" << std::endl;
+
+    for (size_t level = 0; level < image.levels.size(); level++)
+    {
+        const mg::CompressedLevel& compressedLevel = image.levels[level];
+        std::cout << "  level " << level << ": " << compressedLevel.width << "x" << compressedLevel.height
+            << ", " << compressedLevel.size << " bytes" << std::endl;
+    }
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::string command = argv[1];
+
+    if (command == "compress")
+        return compress(argc, argv);
+
+    if (command == "atlas")
+        return atlas(argc, argv);
+
+    if (command == "info")
+        return info(argc, argv);
+
+    printUsage();
+    return 1;
+}